@@ -0,0 +1,44 @@
+#!/bin/bash
+# Command substitution in a loop: $(pwd) and $(echo $X) run in the shell
+# with their output captured, $(cat FILE) forks a child and reads its
+# output from a pipe. bash is timed on the same scripts for reference.
+# Run from repo root (where ./bin/myshell exists)
+#   usage: bench/bench_cmdsub.sh [iterations]
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+N=${1:-2000}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+now() { date +%s.%N; }
+
+echo "some text" > "$tmp/file.txt"
+
+gen() {
+  echo "X=value"
+  echo "for i in $(seq -s " " "$N"); do"
+  echo "Y=$1"
+  echo "done"
+}
+
+run() {
+  local t0 t1
+  t0=$(now)
+  "$1" "$3" < /dev/null > /dev/null 2>&1
+  t1=$(now)
+  awk -v n="$2" -v a="$t0" -v b="$t1" -v it="$N" \
+    'BEGIN { printf "%-30s %8.3f s  %8.1f us/iter\n", n, b - a, (b - a) * 1e6 / it }'
+}
+
+gen '$(pwd)' > "$tmp/pwd.sh"
+gen '$(echo $X)' > "$tmp/echo.sh"
+gen "\$(cat $tmp/file.txt)" > "$tmp/cat.sh"
+for s in pwd echo cat; do
+  run "$MYSHELL" "myshell \$($s ...)" "$tmp/$s.sh"
+  run bash "bash \$($s ...)" "$tmp/$s.sh"
+done
@@ -0,0 +1,49 @@
+#!/bin/bash
+# Querying a helper once per loop iteration: a new sed per query
+# (R=$(echo $i | sed ...)) vs one warm sed started with 'coproc' and
+# spoken to over its two pipes (echo >&$S_IN; read <&$S_OUT).
+# Run from repo root (where ./bin/myshell exists)
+#   usage: bench/bench_coproc.sh [iterations]
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+N=${1:-2000}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+now() { date +%s.%N; }
+
+SED="sed -u y/0123456789/abcdefghij/"
+
+{
+  echo "for i in $(seq -s " " "$N"); do"
+  echo "R=\$(echo \$i | $SED)"
+  echo "done"
+  echo "echo \$R"
+} > "$tmp/spawn.sh"
+
+{
+  echo "coproc S $SED"
+  echo "for i in $(seq -s " " "$N"); do"
+  echo "echo \$i >&\$S_IN"
+  echo "read R <&\$S_OUT"
+  echo "done"
+  echo "echo \$R"
+  echo "coproc -c S"
+} > "$tmp/coproc.sh"
+
+run() {
+  local t0 t1 out
+  t0=$(now)
+  out=$("$MYSHELL" "$2" < /dev/null 2>&1)
+  t1=$(now)
+  awk -v n="$1" -v a="$t0" -v b="$t1" -v it="$N" -v o="$out" \
+    'BEGIN { printf "%-22s %8.3f s  %8.1f us/query  (last: %s)\n", n, b - a, (b - a) * 1e6 / it, o }'
+}
+
+run "new process per query" "$tmp/spawn.sh"
+run "coproc"                "$tmp/coproc.sh"
@@ -0,0 +1,65 @@
+#!/bin/bash
+# Processes created per script: 'set +o utils' (echo, test, [, printf,
+# true and false run from PATH) vs the in-process builtins, where the only
+# external command is the last line and is exec()ed in place of the shell.
+# Counts pids handed out by the kernel (ns_last_pid), so it is only exact
+# on an otherwise idle machine; an empty script's count (the shell itself
+# plus this script's helpers) is subtracted.
+# Run from repo root (where ./bin/myshell exists)
+#   usage: bench/bench_forks.sh [lines]
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+if [ ! -r /proc/sys/kernel/ns_last_pid ]; then
+  echo "ERROR: /proc/sys/kernel/ns_last_pid not readable."
+  exit 2
+fi
+
+N=${1:-500}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+now() { date +%s.%N; }
+
+# a typical script prologue: checks and messages, then one real command
+gen() {
+  [ -n "$1" ] && echo "$1"
+  for ((i = 0; i < N; i++)); do
+    echo "test -d /tmp"
+    echo "[ -n \"\$HOME\" ]"
+    echo "echo line $i > /dev/null"
+    echo "printf '%s %d\\n' item $i > /dev/null"
+    echo "true"
+  done
+  echo "ls /tmp > /dev/null"
+}
+
+# sets pids and secs
+measure() {
+  local p0 p1 t0 t1
+  p0=$(< /proc/sys/kernel/ns_last_pid)
+  t0=$(now)
+  "$MYSHELL" "$1" < /dev/null > /dev/null 2>&1
+  t1=$(now)
+  p1=$(< /proc/sys/kernel/ns_last_pid)
+  pids=$((p1 - p0))
+  ((pids < 0)) && pids=$((pids + $(< /proc/sys/kernel/pid_max) - 300)) # wrapped (restarts at 300)
+  secs=$(awk -v a="$t0" -v b="$t1" 'BEGIN { printf "%.3f", b - a }')
+}
+
+run() {
+  measure "$2"
+  printf "%-24s %6d cmds  %6d forks  %8s s\n" "$1" "$((N * 5 + 1))" "$((pids - base))" "$secs"
+}
+
+: > "$tmp/empty.sh"
+measure "$tmp/empty.sh"
+base=$pids
+
+gen "set +o utils" > "$tmp/ext.sh"
+gen > "$tmp/int.sh"
+run "set +o utils"    "$tmp/ext.sh"
+run "builtins + exec" "$tmp/int.sh"
@@ -0,0 +1,38 @@
+#!/bin/bash
+# Pathname expansion over a large directory: four patterns on one command
+# line (the directory is read and sorted once) vs the same patterns on
+# four lines (read once each), with the in-shell 'true' so only the
+# expansion is timed. bash runs the one-line script for comparison.
+# Run from repo root (where ./bin/myshell exists)
+#   usage: bench/bench_glob.sh [entries]
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+N=${1:-100000}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+mkdir "$tmp/d"
+(cd "$tmp/d" && seq -f 'f%06g.log' 1 2 "$N" | xargs touch && seq -f 'g%06g.dat' 2 2 "$N" | xargs touch)
+
+now() { date +%s.%N; }
+
+echo "cd $tmp/d; true f*.log; true g*.dat; true *[05].log; true f00*" > "$tmp/one.sh"
+printf '%s\n' "cd $tmp/d" "true f*.log" "true g*.dat" "true *[05].log" "true f00*" > "$tmp/four.sh"
+
+run() {
+  local t0 t1
+  t0=$(now)
+  "$1" "$2" < /dev/null > /dev/null 2>&1
+  t1=$(now)
+  awk -v n="$3" -v a="$t0" -v b="$t1" 'BEGIN { printf "%-28s %8.1f ms\n", n, (b - a) * 1e3 }'
+}
+
+echo "$N entries"
+run "$MYSHELL" "$tmp/one.sh"  "myshell, one line"
+run "$MYSHELL" "$tmp/four.sh" "myshell, four lines"
+run bash       "$tmp/one.sh"  "bash, one line"
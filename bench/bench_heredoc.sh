@@ -0,0 +1,57 @@
+#!/bin/bash
+# Feeding inline text to a command: a here-document (small: pipe written
+# up front; large: memfd) vs the temp-file pattern it replaces (write the
+# file with a builtin, redirect it in, remove it). Each script runs the
+# same loop N times; the bodies are expanded on every iteration.
+# Run from repo root (where ./bin/myshell exists)
+#   usage: bench/bench_heredoc.sh [iterations]
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+N=${1:-1000}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+now() { date +%s.%N; }
+
+# body lines: 3 (about 60 bytes) or 2000 (about 60 KiB)
+body() {
+  for ((i = 0; i < $1; i++)); do echo "line $i of \$i: 0123456789abcdefghij"; done
+}
+
+gen_heredoc() {
+  echo "for i in $(seq -s " " "$N"); do"
+  echo "cat > /dev/null <<EOF"
+  body "$1"
+  echo "EOF"
+  echo "done"
+}
+
+gen_tmpfile() {
+  echo "for i in $(seq -s " " "$N"); do"
+  # one printf with a quoted argument per line (no line continuations)
+  echo "printf '%s\\n' $(body "$1" | sed 's/.*/"&"/' | tr '\n' ' ') > $tmp/in.txt"
+  echo "cat > /dev/null < $tmp/in.txt"
+  echo "rm $tmp/in.txt"
+  echo "done"
+}
+
+run() {
+  local t0 t1
+  t0=$(now)
+  "$MYSHELL" "$2" < /dev/null > /dev/null 2>&1
+  t1=$(now)
+  awk -v n="$1" -v a="$t0" -v b="$t1" -v it="$N" \
+    'BEGIN { printf "%-22s %8.3f s  %8.1f us/iter\n", n, b - a, (b - a) * 1e6 / it }'
+}
+
+for size in 3 2000; do
+  gen_heredoc $size > "$tmp/hd_$size.sh"
+  gen_tmpfile $size > "$tmp/tf_$size.sh"
+  run "heredoc ($size lines)"  "$tmp/hd_$size.sh"
+  run "temp file ($size lines)" "$tmp/tf_$size.sh"
+done
@@ -0,0 +1,163 @@
+// Microbenchmarks for the per-line hot path: parse_line() (lexing and
+// parsing, once per command), expand_command() (once per run, e.g. every
+// loop iteration), process_assignments() (prefix assignments, set and
+// undone), the variable table, the exec environment (rebuilt after an
+// exported variable changed vs cached) and the PATH completion index
+// (first build, then one prefix lookup). Prints one
+// JSON object with nanoseconds per call (per word for the long line);
+// bench/run_bench.sh embeds it in the 'make bench' report.
+// Build and run from repo root: make bench/bench_micro && ./bench/bench_micro
+#include "shell.h"
+#include <time.h>
+
+#define BATCH  1024
+#define ROUNDS 200
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double bench_parse(const char *line)
+{
+    arena_t a = {0};
+    double total = 0;
+    for (int r = 0; r < ROUNDS; r++) {
+        double t0 = now_ns();
+        for (int i = 0; i < BATCH; i++) {
+            if (!parse_line(line, &a)) { fprintf(stderr, "parse failed\n"); exit(1); }
+            if ((i & 63) == 63) arena_reset(&a);
+        }
+        total += now_ns() - t0;
+        arena_reset(&a);
+    }
+    arena_destroy(&a);
+    return total / ((double)BATCH * ROUNDS);
+}
+
+// Parse once, then time fn over BATCH fresh expansions of the command
+static double bench_on_command(const char *line, void (*fn)(char **, arena_t *))
+{
+    arena_t tree = {0}, a = {0}, scratch = {0};
+    node_t *n = parse_line(line, &tree);
+    char ***lists = (char***)malloc(BATCH * sizeof(char**));
+    double total = 0;
+    for (int r = 0; r < ROUNDS; r++) {
+        double t0 = now_ns();
+        for (int i = 0; i < BATCH; i++) lists[i] = expand_command(n, &a);
+        double t1 = now_ns();
+        if (fn) {
+            for (int i = 0; i < BATCH; i++) fn(lists[i], &scratch);
+            total += now_ns() - t1;
+        } else
+            total += t1 - t0;
+        arena_reset(&a);
+        arena_reset(&scratch);
+    }
+    free(lists);
+    arena_destroy(&tree);
+    arena_destroy(&a);
+    arena_destroy(&scratch);
+    return total / ((double)BATCH * ROUNDS);
+}
+
+static void do_assignments(char **argv, arena_t *a)
+{
+    (void)a;
+    process_assignments(argv);
+    restore_assignments();
+}
+
+int main(void)
+{
+    char name[32], value[32];
+    for (int i = 0; i < 1024; i++) {
+        snprintf(name, sizeof(name), "VAR_%d", i);
+        snprintf(value, sizeof(value), "value%d", i);
+        set_var(name, value);
+    }
+    set_var("HOME_DIR", "/home/user");
+
+    // a long line: 1000 plain words
+    size_t cap = 1000 * 8 + 1, len = 0;
+    char *longline = (char*)malloc(cap);
+    for (int i = 0; i < 1000; i++)
+        len += (size_t)snprintf(longline + len, cap - len, "word%03d ", i);
+
+    const char *expline = "echo $VAR_1 \"${VAR_500}:$HOME_DIR\" pre$UNDEFINED plain";
+    double parse_short = bench_parse("ls -l \"my file\" | grep -v foo > out.txt");
+    double parse_long = bench_parse(longline) / 1000.0;
+    double parse_exp = bench_parse(expline);
+    double expand = bench_on_command(expline, NULL);
+    double assign = bench_on_command("A=1 B=two C=three cmd arg1 arg2", do_assignments);
+
+    const int lookups = 2000000;
+    char (*names)[32] = malloc(1024 * sizeof(*names));
+    for (int i = 0; i < 1024; i++) snprintf(names[i], sizeof(names[i]), "VAR_%d", i);
+    volatile size_t sink = 0;
+    unsigned x = 12345;
+    double t0 = now_ns();
+    for (int i = 0; i < lookups; i++) {
+        x = x * 1103515245u + 12345u;
+        sink += strlen(get_var(names[x % 1024u]));
+    }
+    double t1 = now_ns();
+    for (int i = 0; i < lookups; i++) {
+        x = x * 1103515245u + 12345u;
+        set_var(names[x % 1024u], "v");
+    }
+    double t2 = now_ns();
+
+    // 100 exported variables, as in a typical login environment
+    for (int i = 0; i < 100; i++) {
+        snprintf(name, sizeof(name), "ENV_%d", i);
+        snprintf(value, sizeof(value), "/some/value/%d", i);
+        char *ex[] = { "export", name, NULL };
+        set_var(name, value);
+        builtin_export(ex);
+    }
+    const int envs = 20000;
+    double te0 = now_ns();
+    for (int i = 0; i < envs; i++) {
+        set_var("ENV_0", (i & 1) ? "a" : "b"); // exported: marks envp dirty
+        sink += (size_t)shell_envp();
+    }
+    double te1 = now_ns();
+    for (int i = 0; i < envs; i++) sink += (size_t)shell_envp();
+    double te2 = now_ns();
+    (void)sink;
+
+    // the index is built by its own thread; wait for the first snapshot
+    double t3 = now_ns();
+    cmd_index_start();
+    char **m;
+    while (!(m = cmd_index_complete(""))) usleep(100);
+    double t4 = now_ns();
+    size_t ncmds = 0;
+    for (; m[ncmds]; ncmds++) free(m[ncmds]);
+    free(m);
+    const int completions = 2000;
+    double t5 = now_ns();
+    for (int i = 0; i < completions; i++) {
+        char **l = cmd_index_complete("ls");
+        for (size_t k = 0; l && l[k]; k++) free(l[k]);
+        free(l);
+    }
+    double t6 = now_ns();
+
+    printf("{\"parse_ns\": %.1f, \"parse_long_ns_per_word\": %.2f, "
+           "\"parse_expand_line_ns\": %.1f, \"expand_ns\": %.1f, "
+           "\"process_assignments_ns\": %.1f, "
+           "\"get_var_ns\": %.1f, \"set_var_ns\": %.1f, \"vars\": 1024, "
+           "\"envp_rebuild_ns\": %.1f, \"envp_cached_ns\": %.1f, \"exported\": 100, "
+           "\"path_index_build_ms\": %.2f, \"path_commands\": %zu, \"complete_ns\": %.1f}\n",
+           parse_short, parse_long, parse_exp, expand, assign,
+           (t1 - t0) / lookups, (t2 - t1) / lookups,
+           (te1 - te0) / envs, (te2 - te1) / envs,
+           (t4 - t3) / 1e6, ncmds, (t6 - t5) / completions);
+    free(names);
+    free(longline);
+    return 0;
+}
@@ -0,0 +1,41 @@
+#!/bin/bash
+# Pipeline throughput in MB/s: default pipes vs 'pipesize', stages pinned
+# together ('affinity CPUS', default: the first CPU) and a file sink
+# through 'cat > file' (read/write copies) vs the 'tee' builtin (splice).
+# Run from repo root (where ./bin/myshell exists)
+#   usage: bench/bench_pipe.sh [megabytes] [pipesize] [cpus]
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+MB=${1:-1024}
+PSZ=${2:-1M}
+CPUS=${3:-$(cut -d, -f1 /sys/devices/system/cpu/online | cut -d- -f1)}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+src="head -c ${MB}M /dev/zero"
+
+now() { date +%s.%N; }
+
+run() {
+  local label="$1" cmd="$2"
+  local t0 t1
+  t0=$(now)
+  "$MYSHELL" -c "$cmd" < /dev/null > /dev/null 2>&1
+  t1=$(now)
+  awk -v l="$label" -v mb="$MB" -v a="$t0" -v b="$t1" \
+    'BEGIN { d = b - a; if (d <= 0) d = 1e-9; printf "%-32s %6d MB  %8.3f s  %9.1f MB/s\n", l, mb, d, mb / d }'
+}
+
+echo "pipe-max-size: $(cat /proc/sys/fs/pipe-max-size 2>/dev/null)"
+run "3 stages, default pipes"       "$src | cat | cat > /dev/null"
+run "3 stages, pipesize $PSZ"       "pipesize $PSZ $src | cat | cat > /dev/null"
+run "3 stages, affinity $CPUS"      "affinity $CPUS $src | cat | cat > /dev/null"
+run "file sink: cat > file"         "$src | cat > $tmp/out"
+run "file sink: tee > file"         "$src | tee > $tmp/out"
+run "file sink, pipesize $PSZ: tee" "pipesize $PSZ $src | tee > $tmp/out"
+run "copy: /usr/bin/tee file | cat" "$src | /usr/bin/tee $tmp/out | cat > /dev/null"
+run "copy: tee file | cat"          "$src | tee $tmp/out | cat > /dev/null"
@@ -0,0 +1,46 @@
+#!/bin/bash
+# Commands-per-second for external commands: posix_spawn vs fork+execvp.
+# Run from repo root (where ./bin/myshell exists)
+#   usage: bench/bench_spawn.sh [commands] [history_lines]
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+N=${1:-2000}
+HIST=${2:-40000}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# Grow the shell first (readline history + variables) so the cost of copying
+# its address space on fork() is visible, as in a long-lived session.
+pad=$(head -c 200 /dev/zero | tr '\0' 'x')
+for ((i = 0; i < HIST; i++)); do echo "V$((i % 500))=$pad$i"; done > "$tmp/prefill"
+for ((i = 0; i < N; i++)); do echo "/bin/true"; done > "$tmp/cmds"
+
+now() { date +%s.%N; }
+
+run() {
+  local mode="$1" with_cmds="$2"
+  { echo "set $mode spawn"; cat "$tmp/prefill"; [ "$with_cmds" = 1 ] && cat "$tmp/cmds"; echo exit; } > "$tmp/in"
+  local t0 t1
+  t0=$(now)
+  "$MYSHELL" < "$tmp/in" > /dev/null 2>&1
+  t1=$(now)
+  awk -v a="$t0" -v b="$t1" 'BEGIN { printf "%.6f", b - a }'
+}
+
+report() {
+  local label="$1" mode="$2"
+  local base full
+  base=$(run "$mode" 0)
+  full=$(run "$mode" 1)
+  awk -v l="$label" -v n="$N" -v b="$base" -v f="$full" \
+    'BEGIN { d = f - b; if (d <= 0) d = 1e-9; printf "%-18s %8d cmds  %8.3f s  %10.1f cmds/s\n", l, n, d, n / d }'
+}
+
+echo "history lines: $HIST"
+report "fork+execvp"  "+o"
+report "posix_spawn"  "-o"
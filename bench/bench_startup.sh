@@ -0,0 +1,53 @@
+#!/bin/bash
+# Startup-to-first-exec time: script fast path vs the readline path.
+# Each run starts myshell, executes /bin/true once and exits, so the wall
+# time is dominated by shell startup plus the first exec.
+# Run from repo root (where ./bin/myshell exists)
+#   usage: bench/bench_startup.sh [runs] [script_lines]
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+RUNS=${1:-300}
+LINES=${2:-20000}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+printf '/bin/true\n' > "$tmp/one.sh"
+for ((i = 0; i < LINES; i++)); do echo "V$((i % 100))=value$i"; done > "$tmp/batch.sh"
+
+now() { date +%s.%N; }
+
+per_run() {
+  local label="$1"; shift
+  local t0 t1
+  t0=$(now)
+  for ((i = 0; i < RUNS; i++)); do "$@" > /dev/null 2>&1; done
+  t1=$(now)
+  awk -v l="$label" -v a="$t0" -v b="$t1" -v n="$RUNS" \
+    'BEGIN { printf "%-28s %8.3f ms/run\n", l, (b - a) * 1000 / n }'
+}
+
+once() {
+  local label="$1"; shift
+  local t0 t1
+  t0=$(now)
+  "$@" > /dev/null 2>&1
+  t1=$(now)
+  awk -v l="$label" -v a="$t0" -v b="$t1" -v n="$LINES" \
+    'BEGIN { printf "%-28s %8.3f ms  (%d lines)\n", l, (b - a) * 1000, n }'
+}
+
+echo "startup-to-first-exec ($RUNS runs)"
+per_run "readline (-i, piped)"  sh -c "$MYSHELL -i < $tmp/one.sh"
+per_run "stdin pipe"            sh -c "cat $tmp/one.sh | $MYSHELL"
+per_run "stdin file (mmap)"     sh -c "$MYSHELL < $tmp/one.sh"
+per_run "script file (mmap)"    "$MYSHELL" "$tmp/one.sh"
+per_run "-c"                    "$MYSHELL" -c /bin/true
+
+echo "batch script"
+once "readline (-i)"            sh -c "$MYSHELL -i < $tmp/batch.sh"
+once "script file (mmap)"       "$MYSHELL" "$tmp/batch.sh"
@@ -0,0 +1,53 @@
+// Microbenchmark: set_var/get_var cost as the number of variables grows.
+// Build and run from repo root: make bench/bench_vars && ./bench/bench_vars
+#include "shell.h"
+#include <time.h>
+
+#define LOOKUPS 2000000
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(void)
+{
+    static const int sizes[] = { 16, 128, 1024, 8192, 65536 };
+    char name[32], value[32];
+    int defined = 0;
+    volatile size_t sink = 0;
+
+    printf("%10s %14s %14s\n", "vars", "get_var ns", "set_var ns");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int n = sizes[s];
+        for (; defined < n; defined++) {
+            snprintf(name, sizeof(name), "VAR_%d", defined);
+            snprintf(value, sizeof(value), "value%d", defined);
+            set_var(name, value);
+        }
+
+        // precompute names so formatting is not part of the measurement
+        char (*names)[32] = malloc((size_t)n * sizeof(*names));
+        if (!names) { perror("malloc"); return 1; }
+        for (int i = 0; i < n; i++) snprintf(names[i], sizeof(names[i]), "VAR_%d", i);
+
+        unsigned x = 12345;
+        double t0 = now_ns();
+        for (int i = 0; i < LOOKUPS; i++) {
+            x = x * 1103515245u + 12345u;
+            sink += strlen(get_var(names[x % (unsigned)n]));
+        }
+        double t1 = now_ns();
+        for (int i = 0; i < LOOKUPS; i++) {
+            x = x * 1103515245u + 12345u;
+            set_var(names[x % (unsigned)n], "v");
+        }
+        double t2 = now_ns();
+        printf("%10d %14.1f %14.1f\n", n, (t1 - t0) / LOOKUPS, (t2 - t1) / LOOKUPS);
+        free(names);
+    }
+    (void)sink;
+    return 0;
+}
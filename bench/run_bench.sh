@@ -0,0 +1,89 @@
+#!/bin/bash
+# 'make bench': microbenchmarks (bench/bench_micro) plus macro benchmarks
+# of the shell binary, printed as one JSON document on stdout so results
+# can be stored and compared over time, e.g.
+#   make -s bench > bench-$(git rev-parse --short HEAD).json
+# Run from repo root (where ./bin/myshell exists)
+#   env: CMDS (trivial commands), PIPES (pipelines per stage count),
+#        STORM (background jobs), ITERS (loop iterations)
+
+MYSHELL=./bin/myshell
+MICRO=./bench/bench_micro
+for f in "$MYSHELL" "$MICRO"; do
+  if [ ! -x "$f" ]; then
+    echo "ERROR: $f not found or not executable. Build first (make bench)." >&2
+    exit 2
+  fi
+done
+
+CMDS=${CMDS:-2000}
+PIPES=${PIPES:-300}
+STORM=${STORM:-1000}
+ITERS=${ITERS:-20000}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+now() { date +%s.%N; }
+
+# seconds to run a script file, minus an empty script's startup cost
+script_secs() {
+  local t0 t1
+  t0=$(now)
+  "$MYSHELL" "$1" < /dev/null > /dev/null 2>&1
+  t1=$(now)
+  awk -v a="$t0" -v b="$t1" -v base="${2:-0}" 'BEGIN { d = b - a - base; if (d <= 0) d = 1e-9; printf "%.6f", d }'
+}
+
+: > "$tmp/empty.sh"
+base=$(script_secs "$tmp/empty.sh")
+
+# trivial external command ('true' is a builtin unless utils is off)
+ext="set +o utils"
+{ echo "$ext"; for ((i = 0; i < CMDS; i++)); do echo "true"; done; } > "$tmp/cmds.sh"
+t=$(script_secs "$tmp/cmds.sh" "$base")
+cmds_per_s=$(awk -v n="$CMDS" -v t="$t" 'BEGIN { printf "%.1f", n / t }')
+
+# pipeline latency by stage count
+lat=""
+for k in 1 2 4 8; do
+  line="true"
+  for ((s = 1; s < k; s++)); do line="$line | true"; done
+  { echo "$ext"; for ((i = 0; i < PIPES; i++)); do echo "$line"; done; } > "$tmp/pipe$k.sh"
+  t=$(script_secs "$tmp/pipe$k.sh" "$base")
+  us=$(awk -v n="$PIPES" -v t="$t" 'BEGIN { printf "%.1f", t * 1e6 / n }')
+  lat="$lat${lat:+, }\"$k\": $us"
+done
+
+# background-job storm: start everything, then wait for all of it
+{ echo "$ext"; for ((i = 0; i < STORM; i++)); do echo "true &"; done; echo "wait"; } > "$tmp/storm.sh"
+t=$(script_secs "$tmp/storm.sh" "$base")
+storm_per_s=$(awk -v n="$STORM" -v t="$t" 'BEGIN { printf "%.1f", n / t }')
+
+# the same builtin-only body as a for loop (parsed once) and unrolled
+# (parsed every time)
+body='X=$i; test -n "$X" && echo "$X" > /dev/null'
+{ printf 'for i in'; for ((i = 0; i < ITERS; i++)); do printf ' %d' $i; done
+  printf '; do\n  %s\ndone\n' "$body"; } > "$tmp/loop.sh"
+for ((i = 0; i < ITERS; i++)); do echo "i=$i; $body"; done > "$tmp/unrolled.sh"
+t=$(script_secs "$tmp/loop.sh" "$base")
+loop_per_s=$(awk -v n="$ITERS" -v t="$t" 'BEGIN { printf "%.1f", n / t }')
+t=$(script_secs "$tmp/unrolled.sh" "$base")
+unrolled_per_s=$(awk -v n="$ITERS" -v t="$t" 'BEGIN { printf "%.1f", n / t }')
+
+micro=$("$MICRO")
+
+cat <<EOF
+{
+  "timestamp": "$(date -u +%Y-%m-%dT%H:%M:%SZ)",
+  "commit": "$(git rev-parse --short HEAD 2>/dev/null || echo unknown)",
+  "cpus": $(nproc),
+  "micro": $micro,
+  "macro": {
+    "startup_ms": $(awk -v b="$base" 'BEGIN { printf "%.3f", b * 1000 }'),
+    "trivial_cmds_per_s": $cmds_per_s,
+    "pipeline_latency_us_by_stages": { $lat },
+    "background_storm": { "jobs": $STORM, "jobs_per_s": $storm_per_s },
+    "loop_iters_per_s": { "for_loop": $loop_per_s, "unrolled": $unrolled_per_s }
+  }
+}
+EOF
@@ -1,60 +1,270 @@
 #ifndef SHELL_H
 #define SHELL_H
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <signal.h>
 #include <errno.h>
+#include <sched.h>
+#include <stdint.h>
 
 // Readline
 #include <readline/readline.h>
 #include <readline/history.h>
 
-#define MAX_LEN 512 
-#define MAXARGS 10
-#define ARGLEN 256  // Increased to accommodate longer variable values and quoted strings
 #define PROMPT "Maaz-OS-A03> "
+#define PROMPT2 "> "      // continuation lines of an if/while/for
+
+// Jobs: every launched pipeline, one proc_t per stage
+typedef struct {
+	pid_t  pid;
+	int    done;            // reaped
+	int    stopped;
+	int    status;          // wait() status once done
+	double wall;            // seconds from job start to exit
+	struct rusage ru;       // once done
+	int    aux;             // a process substitution, not a stage
+} proc_t;
+
+enum { JOB_RUNNING, JOB_STOPPED, JOB_DONE };
 
-// Background jobs
-#define MAXJOBS 64
 typedef struct {
-	pid_t pid;
-	char  cmd[MAX_LEN];
+	int     id;             // job number (%n)
+	pid_t   pgid;           // 0 = runs in the shell's process group
+	int     use_pgrp;       // stages join a process group of their own
+	proc_t *procs;
+	int     nprocs, proc_cap;
+	int     nlive;          // stages not yet reaped
+	char   *cmd;
+	struct timespec start;  // CLOCK_MONOTONIC at launch
+	int     state;          // JOB_*
+	int     foreground;     // being waited for; not listed by 'jobs'
+	int     notified;       // state change already reported
+	double  wall;           // seconds, once done
+	char   *place;          // placement summary for 'jobs' (affinity, nice, ulimit), or NULL
 } job_t;
 
+// Per-line arena: every token of a command line is carved from one arena
+// and released with a single arena_reset(). At most one object may be
+// growing (arena_begin .. arena_finish) at a time, with no arena_alloc in
+// between.
+typedef struct arena_chunk arena_chunk_t;
+typedef struct {
+	arena_chunk_t *cur;   // newest chunk
+	size_t         obj;   // offset of the growing object in cur
+	int            growing;
+} arena_t;
+
+void*  arena_alloc(arena_t *a, size_t n);
+char*  arena_strndup(arena_t *a, const char *s, size_t n);
+void   arena_begin(arena_t *a);
+int    arena_addc(arena_t *a, char c);
+int    arena_addn(arena_t *a, const char *s, size_t n);
+size_t arena_objlen(const arena_t *a);
+char*  arena_finish(arena_t *a);
+void   arena_reset(arena_t *a);
+void   arena_destroy(arena_t *a);
+
+// Set when reading commands through readline (not for scripts, -c or pipes)
+extern int shell_interactive;
+// Set while running the last command of a script or -c string: nothing
+// follows it, so execute() may exec() it in place of forking
+extern int exec_tail;
+
+// Commands (parser.c): read a line at a time, each complete command is
+// parsed into a tree once and run; words expand $NAME, ${NAME}, $? and
+// $(...) each time they run
+typedef struct line_src line_src_t;
+struct line_src {
+	// Next line without its '\n' (not NUL-terminated), valid until the next
+	// call; NULL at end of input. more: a command is still open.
+	const char* (*read)(line_src_t *src, int more, size_t *len);
+	int last;  // set by read(): that was the final line of the input
+};
+typedef struct node node_t;
+void    run_source(line_src_t *src);
+node_t* parse_line(const char *line, arena_t *a);     // one line, NULL on syntax error
+char**  expand_command(const node_t *n, arena_t *a);  // argv of a simple command
+// Operators and prefix keywords in that argv, known by address (a quoted or
+// expanded word with the same text is SYN_NONE); SYN_AT precedes '@CPUS'
+enum { SYN_NONE, SYN_PIPE, SYN_LESS, SYN_GREAT, SYN_DLESS, SYN_TLESS, SYN_LESSAND,
+       SYN_GREATAND, SYN_AT, SYN_TIME, SYN_PIPESIZE, SYN_AFFINITY, SYN_NICE, SYN_ULIMIT,
+       SYN_COUNT };
+int     syntax_word(const char *arg);
+void    procsub_adopt(job_t *j); // <(...) / >(...) children of the command just launched
+void    procsub_reap(void);      // ...or wait for them here
+
+// Pathname expansion of words with unquoted '*', '?', '[' (glob.c). The
+// pattern is the expanded word, '\' quoting characters to match literally;
+// directory listings are cached until glob_cache_clear()
+int    glob_pattern(const char *s);
+char** glob_expand(const char *pattern, arena_t *a, size_t *n); // malloc'd, sorted; NULL if none
+char*  glob_unescape(const char *s, arena_t *a);                 // the word, when nothing matches
+void   glob_cache_clear(void);                                   // after each command line
+
 // Function prototypes
-char** tokenize(char* cmdline);
-int execute(char** arglist, int background, const char* raw_cmd);
-int handle_builtin(char **args);
+int execute(char** arglist, int background, const char* raw_cmd); // exit status
+job_t* spawn_pipeline(char **arglist, const char *raw_cmd, int in_fd, int out_fd,
+                      int background, int *rc);
+int builtin_parallel(char **args);
+int builtin_tee(char **args);
+int builtin_echo(char **args);
+int builtin_printf(char **args);
+int builtin_test(char **args);   // test and [
+int is_builtin(const char *name);
+int run_builtin(char **args);   // exit status
+
+// Builtin output: buffered in the shell and written with write(2) in
+// large chunks; out_flush() runs when each builtin returns
+void out_write(const char *s, size_t n);
+void out_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+void out_flush(void);
+void  out_capture_begin(void);           // $(builtin): collect instead of writing
+char* out_capture_end(size_t *len);      // what was collected, malloc'd (or NULL)
+int  write_all(int fd, const void *buf, size_t n); // 0, or -1 on error
 
 // Jobs management
-void add_job(pid_t pid, const char* cmd);
-void remove_job(pid_t pid);
-void print_jobs(void);
-void reap_background(void);
+extern int job_control;         // interactive: pipelines get their own process group
+extern volatile sig_atomic_t shell_interrupted; // ^C seen by the shell itself
+void   job_control_init(void);
+job_t* job_create(const char *cmd, int foreground);
+int    job_add_proc(job_t *j, pid_t pid);
+int    job_add_aux(job_t *j, pid_t pid);  // waited for, but not a stage
+void   job_remove(job_t *j);
+job_t* job_by_pid(pid_t pid);
+job_t* job_by_spec(const char *spec); // "%n" / "n"; NULL = most recent
+void   job_reaped(pid_t pid, int status, const struct rusage *ru);
+int    job_wait(job_t *j, int give_terminal); // exit status
+int    job_exit_code(const job_t *j);
+void   job_rusage(const job_t *j, struct rusage *total);
+int    status_code(int status);
+void   print_jobs(int verbose);
+void   reap_background(void);
+int    builtin_fg(char **args);
+int    builtin_bg(char **args);
+int    builtin_wait(char **args);
+
+// Child exit events (SIGCHLD via signalfd)
+int  child_events_init(void);   // blocks SIGCHLD; returns the signalfd
+int  child_event_fd(void);
+int  notify_done_jobs(void);    // interactive "[n] Done" notices
+int  jobs_have_notices(void);
 
-// History display helper (implemented using GNU Readline history)
-void history_print(void);
+// Resource accounting ('time' prefix, 'jobs -l')
+double elapsed_since(const struct timespec *start);
+void   print_times(FILE *out, const char *label, double wall, const struct rusage *ru);
+
+// Persistent history ($HISTFILE, default ~/.myshell_history)
+extern long opt_histsize;          // entries kept in memory (0 = default)
+void  hist_init(void);             // interactive startup
+void  hist_add(const char *line);  // readline list + one append to the file
+char* hist_get(long n);            // malloc'd entry n, NULL if unknown
+void  hist_set_size(void);
+void  history_print(long last);    // all kept entries, or the last 'last'
 
 // Readline completion hook
 char** myshell_completion(const char* text, int start, int end);
 
-// Variables feature (v8)
-typedef struct var_s {
-	char *name;
-	char *value;
-	struct var_s *next;
+// Shell options (set -o NAME / set +o NAME)
+extern int  opt_spawn;    // launch commands with posix_spawn instead of fork+exec
+extern int  opt_utils;    // echo/printf/test/[/true/false run in the shell
+extern long opt_pipesize; // F_SETPIPE_SZ for pipeline pipes (0 = kernel default)
+int  set_option(const char *name, const char *value, int on); // value: numeric options
+int  parse_size(const char *s, long *out); // "65536", "64K", "1M"; -1 if invalid
+void print_options(void);
+
+// Execution trace: 'set -o xtrace' records parse, fork/spawn, exec, stage
+// exit and wait events in a ring shared with forked children (trace.c);
+// 'trace dump FILE' writes Chrome trace-event JSON. Test opt_xtrace
+// before calling trace_event() so a disabled trace costs one branch.
+extern int  opt_xtrace;
+extern long opt_tracesize;  // ring slots (0 = default 16384)
+uint64_t trace_now(void);   // ns, CLOCK_MONOTONIC
+void trace_setup(void);     // xtrace or tracesize changed
+void trace_event(char ph, const char *name, pid_t tid, uint64_t ts, uint64_t dur,
+                 int status, const char *detail); // name: a string literal; tid 0 = self
+int  builtin_trace(char **args);
+
+// Coprocesses: 'coproc NAME cmd' keeps cmd running as a background job on
+// two pipes the shell holds, $NAME_IN / $NAME_OUT for '>&' / '<&' (coproc.c)
+int builtin_coproc(char **args);
+
+// Executables in PATH, indexed by a background thread (completion)
+void   cmd_index_start(void);            // interactive startup
+void   cmd_index_path_changed(void);     // PATH was assigned
+char** cmd_index_complete(const char *prefix); // malloc'd list of malloc'd names, or NULL
+
+// Placement and limits: 'affinity CPUS', 'nice', 'ulimit' prefixes and
+// per-stage '@CPUS', applied in each child before exec (placement.c)
+#define PLACE_MAX_LIMITS 8
+enum { RL_SOFT = 1, RL_HARD = 2 };
+typedef struct {
+	int       has_cpus;
+	cpu_set_t cpus;
+	int       nice;      // increment, 0 = unchanged
+	int       nlimits;
+	struct { int idx; int which; rlim_t val; } limits[PLACE_MAX_LIMITS];
+} placement_t;
+int   placement_prefix(char **argv, placement_t *pl); // words used, 0 = not a prefix, -1 = usage error
+int   placement_active(const placement_t *pl);
+int   apply_placement(const placement_t *pl);         // in the child; -1 after reporting
+char* placement_describe(const placement_t *pl);      // malloc'd, NULL if nothing is set
+int   parse_cpus(const char *s, cpu_set_t *set);      // "0-3,8"
+void  format_cpus(const cpu_set_t *set, char *buf, size_t len);
+int   builtin_affinity(char **args);
+int   builtin_ulimit(char **args);
+
+// Resolved command cache (PATH lookups; 'hash' builtin)
+const char* path_lookup(const char *name); // absolute path, or NULL if not found
+void path_cache_clear(void);
+void path_cache_print(void);
+
+// Variables feature (v8): open-addressing table keyed by interned names
+typedef struct {
+	const char *name;  // interned (never freed); NULL = empty slot
+	size_t      hash;
+	char       *value;
+	size_t      cap;   // bytes allocated for value, reused when a new value fits
+	int         flags; // VAR_*
 } var_t;
 
+enum { VAR_EXPORTED = 1, VAR_UNSET = 2 }; // unset: the name stays interned
+
+size_t str_hash(const char *s); // FNV-1a, shared by the shell's hash tables
+int is_valid_var_start(char c);
+int is_valid_var_char(char c);
+
 // Variable management
 void set_var(const char *name, const char *value);
 const char* get_var(const char *name);
+const char* get_varn(const char *name, size_t len);
 void print_vars(void);
-void expand_variables(char **arglist);
-void process_assignments(char **arglist); // removes assignment tokens and stores them
+extern int last_status;  // '$?': exit status of the last command line segment
+// Leading NAME=VALUE words: stored if they are the whole command, else
+// removed from arglist (the tokens are left intact) and set and exported
+// for that command only, until restore_assignments()
+void process_assignments(char **arglist);
+void restore_assignments(void);
+
+// Environment of launched commands: the exported variables, imported
+// from environ at startup. The envp array is cached and rebuilt only
+// after an exported variable changed.
+void   import_environ(void);
+char** shell_envp(void);
+int    builtin_export(char **args);
+int    builtin_unset(char **args);
+int    builtin_read(char **args);
 
 #endif // SHELL_H
 
@@ -0,0 +1,130 @@
+#include "shell.h"
+
+/* ------------ Per-line arena allocator ------------ */
+// Bump allocator over a list of chunks. Besides fixed-size allocations it
+// supports one "growing object" at a time (obstack style): the tokenizer
+// appends characters of the current word and finishes it in place, so no
+// intermediate buffer or strdup is needed and words have no length limit.
+// arena_reset() releases everything at once and keeps the largest chunk
+// for the next line.
+
+#define ARENA_MIN_CHUNK 4096
+#define ARENA_ALIGN     (sizeof(void*))
+
+struct arena_chunk {
+    struct arena_chunk *next;  // older chunk
+    size_t size;
+    size_t used;
+    char   data[];
+};
+
+static arena_chunk_t* new_chunk(size_t min_size, size_t prev_size)
+{
+    size_t size = prev_size ? prev_size * 2 : ARENA_MIN_CHUNK;
+    while (size < min_size) size *= 2;
+    arena_chunk_t *c = (arena_chunk_t*)malloc(sizeof(arena_chunk_t) + size);
+    if (!c) { perror("malloc"); return NULL; }
+    c->next = NULL;
+    c->size = size;
+    c->used = 0;
+    return c;
+}
+
+// Make room for n more bytes; an object under construction moves along
+static int arena_reserve(arena_t *a, size_t n)
+{
+    arena_chunk_t *cur = a->cur;
+    size_t objlen = a->growing ? cur->used - a->obj : 0;
+    if (cur && cur->used + n <= cur->size) return 0;
+
+    arena_chunk_t *c = new_chunk(objlen + n + ARENA_ALIGN, cur ? cur->size : 0);
+    if (!c) return -1;
+    if (objlen) {
+        memcpy(c->data, cur->data + a->obj, objlen);
+        cur->used = a->obj; // drop the partial copy from the old chunk
+    }
+    c->used = objlen;
+    c->next = cur;
+    a->cur = c;
+    a->obj = 0;
+    return 0;
+}
+
+void* arena_alloc(arena_t *a, size_t n)
+{
+    if (a->cur)
+        a->cur->used = (a->cur->used + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    if (!a->cur || a->cur->used + n > a->cur->size) {
+        if (arena_reserve(a, n) < 0) return NULL;
+    }
+    void *p = a->cur->data + a->cur->used;
+    a->cur->used += n;
+    return p;
+}
+
+char* arena_strndup(arena_t *a, const char *s, size_t n)
+{
+    char *p = (char*)arena_alloc(a, n + 1);
+    if (!p) return NULL;
+    memcpy(p, s, n);
+    p[n] = '\0';
+    return p;
+}
+
+void arena_begin(arena_t *a)
+{
+    if (!a->cur && arena_reserve(a, 1) < 0) return;
+    a->growing = 1;
+    a->obj = a->cur->used;
+}
+
+int arena_addn(arena_t *a, const char *s, size_t n)
+{
+    if (arena_reserve(a, n) < 0) return -1;
+    memcpy(a->cur->data + a->cur->used, s, n);
+    a->cur->used += n;
+    return 0;
+}
+
+int arena_addc(arena_t *a, char c)
+{
+    if (a->cur->used == a->cur->size && arena_reserve(a, 1) < 0) return -1;
+    a->cur->data[a->cur->used++] = c;
+    return 0;
+}
+
+size_t arena_objlen(const arena_t *a)
+{
+    return a->growing ? a->cur->used - a->obj : 0;
+}
+
+char* arena_finish(arena_t *a)
+{
+    if (!a->growing || arena_addc(a, '\0') < 0) { a->growing = 0; return NULL; }
+    a->growing = 0;
+    return a->cur->data + a->obj;
+}
+
+void arena_reset(arena_t *a)
+{
+    arena_chunk_t *c = a->cur;
+    if (!c) return;
+    // the newest chunk is the largest; keep it
+    arena_chunk_t *old = c->next;
+    while (old) {
+        arena_chunk_t *next = old->next;
+        free(old);
+        old = next;
+    }
+    c->next = NULL;
+    c->used = 0;
+    a->growing = 0;
+    a->obj = 0;
+}
+
+void arena_destroy(arena_t *a)
+{
+    arena_reset(a);
+    free(a->cur);
+    a->cur = NULL;
+}
@@ -0,0 +1,328 @@
+#include "shell.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+/* ------------ PATH executable index (first-word completion) ------------ */
+// A background thread scans every PATH directory once and publishes a
+// sorted, de-duplicated snapshot of executable names; Tab only takes a
+// lock long enough to copy the matches of a prefix, so it never waits on
+// the filesystem. Each directory is watched with inotify and the thread
+// patches just the entry that changed, then publishes a new snapshot.
+// Assigning PATH makes the thread rescan from scratch. Relative PATH
+// entries (including the empty one, meaning ".") are not indexed: they
+// change with every cd.
+
+typedef struct {
+    char   *path;
+    int     wd;        // inotify watch, -1 if none
+    char  **names;     // sorted executables
+    size_t  n, cap;
+} pdir_t;
+
+typedef struct {
+    size_t  n;
+    char  **names;     // sorted, unique; strings live in the same block
+} snap_t;
+
+static pthread_mutex_t idx_lock = PTHREAD_MUTEX_INITIALIZER;
+static snap_t *snap = NULL;        // current index; NULL until the first scan
+static char   *pending_path = NULL; // PATH handed over by the main thread
+static int     wake_fd = -1;       // eventfd: pending_path was set
+
+// Indexer thread state
+static pdir_t *dirs = NULL;
+static size_t  ndirs = 0;
+static int     ino_fd = -1;
+
+static int name_cmp(const void *a, const void *b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// Regular file with an execute bit; access(2) is left to path_lookup()
+static int is_exec(int dfd, const char *name)
+{
+    struct stat sb;
+    return fstatat(dfd, name, &sb, 0) == 0 && S_ISREG(sb.st_mode) && (sb.st_mode & 0111);
+}
+
+// Position of name in d (found) or where it would go
+static size_t dir_find(const pdir_t *d, const char *name, int *found)
+{
+    size_t lo = 0, hi = d->n;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int c = strcmp(d->names[mid], name);
+        if (c == 0) { *found = 1; return mid; }
+        if (c < 0) lo = mid + 1; else hi = mid;
+    }
+    *found = 0;
+    return lo;
+}
+
+static void dir_add(pdir_t *d, const char *name)
+{
+    int found;
+    size_t i = dir_find(d, name, &found);
+    if (found) return;
+    if (d->n == d->cap) {
+        size_t ncap = d->cap ? d->cap * 2 : 64;
+        char **nv = (char**)realloc(d->names, ncap * sizeof(char*));
+        if (!nv) return;
+        d->names = nv;
+        d->cap = ncap;
+    }
+    char *s = strdup(name);
+    if (!s) return;
+    memmove(d->names + i + 1, d->names + i, (d->n - i) * sizeof(char*));
+    d->names[i] = s;
+    d->n++;
+}
+
+static void dir_remove(pdir_t *d, const char *name)
+{
+    int found;
+    size_t i = dir_find(d, name, &found);
+    if (!found) return;
+    free(d->names[i]);
+    memmove(d->names + i, d->names + i + 1, (d->n - i - 1) * sizeof(char*));
+    d->n--;
+}
+
+static void dir_clear(pdir_t *d)
+{
+    for (size_t i = 0; i < d->n; i++) free(d->names[i]);
+    d->n = 0;
+}
+
+static void dir_scan(pdir_t *d)
+{
+    dir_clear(d);
+    DIR *dp = opendir(d->path);
+    if (!dp) return;
+    int dfd = dirfd(dp);
+    struct dirent *de;
+    while ((de = readdir(dp)) != NULL) {
+        if (de->d_name[0] == '.' || de->d_type == DT_DIR) continue;
+        if (is_exec(dfd, de->d_name)) {
+            // readdir order is arbitrary: append now, sort once below
+            if (d->n == d->cap) {
+                size_t ncap = d->cap ? d->cap * 2 : 64;
+                char **nv = (char**)realloc(d->names, ncap * sizeof(char*));
+                if (!nv) break;
+                d->names = nv;
+                d->cap = ncap;
+            }
+            if (!(d->names[d->n] = strdup(de->d_name))) break;
+            d->n++;
+        }
+    }
+    closedir(dp);
+    qsort(d->names, d->n, sizeof(char*), name_cmp);
+}
+
+// Forget the old directories and index the ones in path
+static void set_dirs(char *path)
+{
+    for (size_t i = 0; i < ndirs; i++) {
+        if (dirs[i].wd >= 0) inotify_rm_watch(ino_fd, dirs[i].wd);
+        dir_clear(&dirs[i]);
+        free(dirs[i].names);
+        free(dirs[i].path);
+    }
+    free(dirs);
+    dirs = NULL;
+    ndirs = 0;
+
+    size_t max = 1;
+    for (const char *c = path; *c; c++) if (*c == ':') max++;
+    dirs = (pdir_t*)calloc(max, sizeof(pdir_t));
+    if (!dirs) return;
+    char *save = NULL;
+    for (char *dir = strtok_r(path, ":", &save); dir; dir = strtok_r(NULL, ":", &save)) {
+        if (dir[0] != '/') continue;
+        int dup = 0;
+        for (size_t i = 0; i < ndirs; i++) dup |= strcmp(dirs[i].path, dir) == 0;
+        if (dup) continue;
+        pdir_t *d = &dirs[ndirs];
+        if (!(d->path = strdup(dir))) break;
+        d->wd = ino_fd < 0 ? -1 :
+            inotify_add_watch(ino_fd, dir, IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_FROM |
+                                           IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+        dir_scan(d);
+        ndirs++;
+    }
+}
+
+static void apply_event(const struct inotify_event *ev)
+{
+    if (ev->mask & IN_Q_OVERFLOW) {
+        for (size_t i = 0; i < ndirs; i++) dir_scan(&dirs[i]);
+        return;
+    }
+    pdir_t *d = NULL;
+    for (size_t i = 0; i < ndirs && !d; i++)
+        if (dirs[i].wd == ev->wd) d = &dirs[i];
+    if (!d) return;
+    if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+        dir_clear(d);
+        if (ev->mask & IN_IGNORED) d->wd = -1;
+        return;
+    }
+    if (!ev->len || ev->name[0] == '.') return;
+    if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        dir_remove(d, ev->name);
+        return;
+    }
+    // created, moved in, or chmod: look at what is there now
+    int dfd = open(d->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dfd < 0) return;
+    if (is_exec(dfd, ev->name)) dir_add(d, ev->name);
+    else dir_remove(d, ev->name);
+    close(dfd);
+}
+
+// Merge every directory into a new snapshot and swap it in
+static void publish(void)
+{
+    size_t total = 0, bytes = 0;
+    for (size_t i = 0; i < ndirs; i++) {
+        total += dirs[i].n;
+        for (size_t k = 0; k < dirs[i].n; k++) bytes += strlen(dirs[i].names[k]) + 1;
+    }
+    char **all = (char**)malloc((total ? total : 1) * sizeof(char*));
+    if (!all) return;
+    size_t m = 0;
+    for (size_t i = 0; i < ndirs; i++)
+        for (size_t k = 0; k < dirs[i].n; k++) all[m++] = dirs[i].names[k];
+    qsort(all, total, sizeof(char*), name_cmp);
+
+    snap_t *s = (snap_t*)malloc(sizeof(snap_t) + total * sizeof(char*) + bytes);
+    if (!s) { free(all); return; }
+    s->names = (char**)(s + 1);
+    s->n = 0;
+    char *p = (char*)(s->names + total);
+    for (size_t i = 0; i < total; i++) {
+        if (s->n && strcmp(s->names[s->n - 1], all[i]) == 0) continue;
+        size_t len = strlen(all[i]) + 1;
+        s->names[s->n++] = memcpy(p, all[i], len);
+        p += len;
+    }
+    free(all);
+
+    pthread_mutex_lock(&idx_lock);
+    snap_t *old = snap;
+    snap = s;
+    pthread_mutex_unlock(&idx_lock);
+    free(old);
+}
+
+static void* indexer(void *arg)
+{
+    (void)arg;
+    char evbuf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;) {
+        struct pollfd fds[2] = {
+            { .fd = wake_fd, .events = POLLIN },
+            { .fd = ino_fd,  .events = POLLIN },
+        };
+        if (poll(fds, ino_fd >= 0 ? 2 : 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            return NULL;
+        }
+        if (fds[0].revents & POLLIN) {
+            uint64_t v;
+            if (read(wake_fd, &v, sizeof(v)) < 0 && errno != EAGAIN) return NULL;
+            pthread_mutex_lock(&idx_lock);
+            char *path = pending_path;
+            pending_path = NULL;
+            pthread_mutex_unlock(&idx_lock);
+            if (path) {
+                set_dirs(path);
+                free(path);
+            }
+        }
+        if (ino_fd >= 0 && (fds[1].revents & POLLIN)) {
+            // apply everything queued so far, then publish once
+            ssize_t n;
+            while ((n = read(ino_fd, evbuf, sizeof(evbuf))) > 0) {
+                for (char *p = evbuf; p < evbuf + n; ) {
+                    const struct inotify_event *ev = (const struct inotify_event*)p;
+                    apply_event(ev);
+                    p += sizeof(struct inotify_event) + ev->len;
+                }
+            }
+        }
+        publish();
+    }
+}
+
+// Hand the current PATH to the indexer thread
+void cmd_index_path_changed(void)
+{
+    if (wake_fd < 0) return;
+    const char *path = getenv("PATH");
+    char *copy = strdup(path ? path : "/usr/local/bin:/usr/bin:/bin");
+    if (!copy) return;
+    pthread_mutex_lock(&idx_lock);
+    free(pending_path);
+    pending_path = copy;
+    pthread_mutex_unlock(&idx_lock);
+    uint64_t one = 1;
+    if (write(wake_fd, &one, sizeof(one)) < 0) perror("cmd index: eventfd");
+}
+
+// Interactive startup. The thread blocks every signal so they all keep
+// going to the shell's main thread.
+void cmd_index_start(void)
+{
+    wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd < 0) { perror("cmd index: eventfd"); return; }
+    ino_fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK); // no watches: index stays as scanned
+    cmd_index_path_changed();
+
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    pthread_t tid;
+    int err = pthread_create(&tid, NULL, indexer, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (err) {
+        fprintf(stderr, "myshell: cmd index: %s\n", strerror(err));
+        close(wake_fd);
+        wake_fd = -1;
+        return;
+    }
+    pthread_detach(tid);
+}
+
+// Indexed commands starting with prefix: a malloc'd NULL-terminated list
+// of malloc'd names (NULL if none, or no index yet)
+char** cmd_index_complete(const char *prefix)
+{
+    size_t plen = strlen(prefix);
+    char **list = NULL;
+    pthread_mutex_lock(&idx_lock);
+    if (snap) {
+        size_t lo = 0, hi = snap->n;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (strcmp(snap->names[mid], prefix) < 0) lo = mid + 1; else hi = mid;
+        }
+        size_t end = lo;
+        while (end < snap->n && strncmp(snap->names[end], prefix, plen) == 0) end++;
+        if (end > lo && (list = (char**)malloc((end - lo + 1) * sizeof(char*)))) {
+            size_t k = 0;
+            for (size_t i = lo; i < end; i++)
+                if ((list[k] = strdup(snap->names[i]))) k++;
+            list[k] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&idx_lock);
+    return list;
+}
@@ -0,0 +1,154 @@
+#include "shell.h"
+#include <fcntl.h>
+
+/* ------------ Coprocesses ------------ */
+// 'coproc NAME cmd [args...]' starts cmd as a background job, like
+// 'cmd &', with its stdin and stdout on two pipes whose other ends the
+// shell keeps: $NAME_IN is the descriptor to write requests to
+// ('echo 2+2 >&$NAME_IN'), $NAME_OUT the one to read answers from
+// ('read X <&$NAME_OUT') and $NAME_PID the process. A loop can then stream
+// its work through one warm process instead of starting one per item.
+// The shell's ends are CLOEXEC, so commands it launches never hold them
+// (they get a copy through '<&' / '>&' only): the coprocess sees EOF once
+// 'coproc -c NAME' closes them. The job itself is reaped and reported
+// like any other background job.
+
+typedef struct {
+    char  *name;
+    pid_t  pid;
+    int    in_fd;   // write end of the coprocess's stdin
+    int    out_fd;  // read end of its stdout
+} coproc_t;
+
+static coproc_t *coprocs = NULL;
+static size_t    ncoprocs = 0, coprocs_cap = 0;
+
+#define COPROC_NAME_MAX 200
+
+static coproc_t* coproc_find(const char *name)
+{
+    for (size_t i = 0; i < ncoprocs; i++)
+        if (strcmp(coprocs[i].name, name) == 0) return &coprocs[i];
+    return NULL;
+}
+
+static void set_num_var(const char *name, const char *suffix, long v)
+{
+    char var[COPROC_NAME_MAX + 8], num[24];
+    snprintf(var, sizeof(var), "%s_%s", name, suffix);
+    snprintf(num, sizeof(num), "%ld", v);
+    set_var(var, num);
+}
+
+// Close the shell's ends and drop the variables; the process runs on
+// until it sees EOF and is reaped as its job
+static void coproc_close(coproc_t *c)
+{
+    close(c->in_fd);
+    close(c->out_fd);
+    char in[COPROC_NAME_MAX + 8], out[COPROC_NAME_MAX + 8], pid[COPROC_NAME_MAX + 8];
+    snprintf(in, sizeof(in), "%s_IN", c->name);
+    snprintf(out, sizeof(out), "%s_OUT", c->name);
+    snprintf(pid, sizeof(pid), "%s_PID", c->name);
+    char *args[] = { "unset", in, out, pid, NULL };
+    builtin_unset(args);
+    free(c->name);
+    *c = coprocs[--ncoprocs];
+}
+
+static void coproc_list(void)
+{
+    for (size_t i = 0; i < ncoprocs; i++) {
+        const coproc_t *c = &coprocs[i];
+        const job_t *j = job_by_pid(c->pid);
+        const char *state = !j ? "exited" : j->state == JOB_STOPPED ? "stopped" : "running";
+        out_printf("%-12s pid %-8d in %-4d out %-4d %s\n", c->name, (int)c->pid,
+                   c->in_fd, c->out_fd, state);
+    }
+}
+
+// The command line as 'jobs' shows it
+static char* coproc_cmd(char **args)
+{
+    size_t len = 0;
+    for (int i = 0; args[i]; i++) len += strlen(args[i]) + 1;
+    char *s = (char*)malloc(len + 1), *p = s;
+    if (!s) { perror("malloc"); return NULL; }
+    for (int i = 0; args[i]; i++)
+        p += sprintf(p, i ? " %s" : "%s", args[i]);
+    *p = '\0';
+    return s;
+}
+
+// coproc NAME cmd [args...] | coproc -c NAME | coproc
+int builtin_coproc(char **args)
+{
+    if (!args[1]) {
+        coproc_list();
+        return 0;
+    }
+    if (strcmp(args[1], "-c") == 0) {
+        coproc_t *c = args[2] ? coproc_find(args[2]) : NULL;
+        if (!c) {
+            fprintf(stderr, "myshell: coproc: %s: no such coprocess\n", args[2] ? args[2] : "(none)");
+            return 1;
+        }
+        coproc_close(c);
+        return 0;
+    }
+    const char *name = args[1];
+    int ok = args[2] && strlen(name) <= COPROC_NAME_MAX && is_valid_var_start(*name);
+    for (const char *c = name + 1; ok && *c; c++) ok = is_valid_var_char(*c);
+    if (!ok) {
+        fprintf(stderr, "myshell: coproc: usage: coproc NAME cmd [args...] | coproc -c NAME | coproc\n");
+        return 2;
+    }
+    if (ncoprocs == coprocs_cap) {
+        size_t ncap = coprocs_cap ? coprocs_cap * 2 : 4;
+        coproc_t *nc = (coproc_t*)realloc(coprocs, ncap * sizeof(coproc_t));
+        if (!nc) { perror("realloc"); return 1; }
+        coprocs = nc;
+        coprocs_cap = ncap;
+    }
+    // a second coprocess of the same name replaces the first one's ends
+    coproc_t *old = coproc_find(name);
+    if (old) coproc_close(old);
+
+    int to[2], from[2];
+    if (pipe2(to, O_CLOEXEC) < 0) { perror("pipe"); return 1; }
+    if (pipe2(from, O_CLOEXEC) < 0) {
+        perror("pipe");
+        close(to[0]);
+        close(to[1]);
+        return 1;
+    }
+    char *cmd = coproc_cmd(args);
+    int rc;
+    job_t *j = spawn_pipeline(args + 2, cmd ? cmd : args[2], to[0], from[1], 1, &rc);
+    free(cmd);
+    close(to[0]);
+    close(from[1]);
+    if (!j) {
+        close(to[1]);
+        close(from[0]);
+        return rc ? rc : 1;
+    }
+    coproc_t *c = &coprocs[ncoprocs];
+    c->name = strdup(name);
+    if (!c->name) {
+        perror("strdup");
+        close(to[1]);
+        close(from[0]);
+        return 1;
+    }
+    c->pid = j->procs[0].pid;
+    c->in_fd = to[1];
+    c->out_fd = from[0];
+    ncoprocs++;
+    set_num_var(name, "IN", c->in_fd);
+    set_num_var(name, "OUT", c->out_fd);
+    set_num_var(name, "PID", (long)c->pid);
+    if (shell_interactive)
+        out_printf("[%d] %d\n", j->id, (int)j->pgid);
+    return 0;
+}
@@ -1,176 +1,724 @@
 #include "shell.h"
 #include <fcntl.h>
+#include <limits.h>
+#include <spawn.h>
+#include <signal.h>
+#include <sys/mman.h>
 
-int execute(char* arglist[], int background, const char* raw_cmd) {
-    if (arglist == NULL || arglist[0] == NULL)
+typedef struct {
+    char **argv;     // points into the (compacted) arglist
+    char *infile;
+    char *outfile;
+    char *heredoc;   // '<<' / '<<<' text for stdin (instead of infile)
+    int   heredoc_nl; // '<<<': add a newline
+    char *infd;      // '<&N': stdin from the shell's descriptor N (instead of infile)
+    char *outfd;     // '>&N': stdout to descriptor N (instead of outfile)
+    int   has_cpus;  // '@CPUS' at the start of the stage
+    cpu_set_t cpus;
+} stage_t;
+
+// A descriptor reading back text (plus a newline if nl). Up to PIPE_BUF
+// bytes fit in a pipe without blocking, so they are written up front; more
+// goes into an anonymous memfd rewound to the start, so no temporary file
+// and no writer process are needed whatever the size.
+static int heredoc_fd(const char *text, int nl)
+{
+    size_t len = strlen(text);
+    if (len + (size_t)nl <= PIPE_BUF) {
+        int p[2];
+        if (pipe2(p, O_CLOEXEC) < 0) { perror("pipe"); return -1; }
+        if ((len && write(p[1], text, len) < 0) || (nl && write(p[1], "\n", 1) < 0)) {
+            perror("write");
+            close(p[0]);
+            close(p[1]);
+            return -1;
+        }
+        close(p[1]);
+        return p[0];
+    }
+    int fd = memfd_create("heredoc", MFD_CLOEXEC);
+    if (fd < 0) { perror("memfd_create"); return -1; }
+    if (write_all(fd, text, len) < 0 || (nl && write_all(fd, "\n", 1) < 0) ||
+        lseek(fd, 0, SEEK_SET) < 0) {
+        perror("heredoc");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// A CLOEXEC copy of the shell's descriptor named by '<&N' / '>&N'
+static int dup_redir(const char *num)
+{
+    char *end;
+    long fd = strtol(num, &end, 10);
+    int copy = -1;
+    if (*num && !*end && fd >= 0 && fd <= INT_MAX)
+        copy = fcntl((int)fd, F_DUPFD_CLOEXEC, 3);
+    if (copy < 0) fprintf(stderr, "myshell: %s: bad file descriptor\n", num);
+    return copy;
+}
+
+// Open the '<' / '>' files of a stage in the parent so errors are reported
+// exactly as before, without having to fork first. Descriptors are CLOEXEC;
+// the launcher dup2()s them onto 0/1, which clears the flag on the copy.
+// '<&N' / '>&N' are copies of N opened the same way.
+static int open_redirs(const stage_t *st, int *in_fd, int *out_fd)
+{
+    *in_fd = -1;
+    *out_fd = -1;
+    if (st->heredoc && (*in_fd = heredoc_fd(st->heredoc, st->heredoc_nl)) < 0)
+        return -1;
+    if (st->infile) {
+        *in_fd = open(st->infile, O_RDONLY | O_CLOEXEC);
+        if (*in_fd < 0) { perror("open <"); return -1; }
+    }
+    if (st->infd && (*in_fd = dup_redir(st->infd)) < 0)
+        return -1;
+    if (st->outfile || st->outfd) {
+        *out_fd = st->outfd ? dup_redir(st->outfd)
+                            : open(st->outfile, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (*out_fd < 0) {
+            if (st->outfile) perror("open >");
+            if (*in_fd >= 0) { close(*in_fd); *in_fd = -1; }
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Signals the interactive shell ignores; children must get them back
+static void job_signals(sigset_t *set)
+{
+    sigemptyset(set);
+    sigaddset(set, SIGTSTP);
+    sigaddset(set, SIGTTIN);
+    sigaddset(set, SIGTTOU);
+}
+
+// execvp()'s fallback for a file the kernel will not run (ENOEXEC: no
+// '#!' line): the same arguments go to /bin/sh. shv has room for argc + 2
+// pointers; no allocation, so it is safe in a forked child.
+static char** sh_argv(char **shv, const char *path, char **argv)
+{
+    int k = 0;
+    shv[k++] = "/bin/sh";
+    shv[k++] = (char*)path;
+    for (int i = 1; argv[i]; i++) shv[k++] = argv[i];
+    shv[k] = NULL;
+    return shv;
+}
+
+static int argv_count(char **argv)
+{
+    int n = 0;
+    while (argv[n]) n++;
+    return n;
+}
+
+// The exit status of a stage launch_stage() could not start: 127 if the
+// command was not found, 126 if it could not be executed, as from a child
+static int launch_status = 127;
+
+// posix_spawn backend: glibc implements it with clone(CLONE_VM|CLONE_VFORK),
+// so the shell's page tables are never copied no matter how large the
+// history or variable table has grown.
+static pid_t spawn_stage(const char *path, char **argv, int in_fd, int out_fd, pid_t pgid)
+{
+    posix_spawn_file_actions_t fa;
+    posix_spawnattr_t attr;
+    if (posix_spawn_file_actions_init(&fa) != 0) return -1;
+    if (posix_spawnattr_init(&attr) != 0) { posix_spawn_file_actions_destroy(&fa); return -1; }
+    // the shell blocks SIGCHLD (see child_events_init); children start clean
+    sigset_t none;
+    sigemptyset(&none);
+    posix_spawnattr_setsigmask(&attr, &none);
+    short flags = POSIX_SPAWN_SETSIGMASK;
+    if (pgid >= 0) {
+        posix_spawnattr_setpgroup(&attr, pgid);
+        flags |= POSIX_SPAWN_SETPGROUP;
+    }
+    if (job_control) {
+        sigset_t def;
+        job_signals(&def);
+        posix_spawnattr_setsigdefault(&attr, &def);
+        flags |= POSIX_SPAWN_SETSIGDEF;
+    }
+    posix_spawnattr_setflags(&attr, flags);
+    if (in_fd >= 0 && in_fd != STDIN_FILENO)
+        posix_spawn_file_actions_adddup2(&fa, in_fd, STDIN_FILENO);
+    if (out_fd >= 0 && out_fd != STDOUT_FILENO)
+        posix_spawn_file_actions_adddup2(&fa, out_fd, STDOUT_FILENO);
+
+    pid_t pid;
+    int rc = posix_spawn(&pid, path, &fa, &attr, argv, shell_envp());
+    if (rc == ENOEXEC) {
+        char *shv[argv_count(argv) + 2];
+        rc = posix_spawn(&pid, "/bin/sh", &fa, &attr, sh_argv(shv, path, argv), shell_envp());
+    }
+    posix_spawn_file_actions_destroy(&fa);
+    posix_spawnattr_destroy(&attr);
+    if (rc != 0) {
+        errno = rc;
+        perror("Command not found");
+        launch_status = rc == ENOENT ? 127 : 126;
         return 0;
+    }
+    return pid;
+}
+
+// Classic fork + exec backend; used when 'set +o spawn' is in effect and
+// for stages with a placement (place != NULL), applied before exec.
+static pid_t fork_stage(const char *path, char **argv, int in_fd, int out_fd, pid_t pgid,
+                        const placement_t *place)
+{
+    char **envp = shell_envp();
+    char *shv[argv_count(argv) + 2];
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork failed");
+        return -1;
+    }
+    if (pid == 0) {
+        if (pgid >= 0) setpgid(0, pgid);
+        if (job_control) {
+            sigset_t def;
+            job_signals(&def);
+            for (int sig = 1; sig < NSIG; sig++)
+                if (sigismember(&def, sig) == 1) signal(sig, SIG_DFL);
+        }
+        sigset_t none;
+        sigemptyset(&none);
+        sigprocmask(SIG_SETMASK, &none, NULL);
+        if (in_fd >= 0 && in_fd != STDIN_FILENO) {
+            if (dup2(in_fd, STDIN_FILENO) < 0) { perror("dup2 <"); _exit(1); }
+        }
+        if (out_fd >= 0 && out_fd != STDOUT_FILENO) {
+            if (dup2(out_fd, STDOUT_FILENO) < 0) { perror("dup2 >"); _exit(1); }
+        }
+        if (place && apply_placement(place) < 0) _exit(126);
+        if (opt_xtrace) trace_event('i', "exec", 0, trace_now(), 0, -1, path);
+        execve(path, argv, envp);
+        if (errno == ENOEXEC) execve("/bin/sh", sh_argv(shv, path, argv), envp);
+        int err = errno;
+        perror("Command not found");
+        _exit(err == ENOENT ? 127 : 126);
+    }
+    return pid;
+}
+
+/* ------------ Builtins as pipeline stages ------------ */
+// A builtin that feeds a pipe runs in a forked copy of the shell, with no
+// exec: it already has the variables, history and job table it prints. A
+// builtin in last position runs in the shell itself with its stdin/stdout
+// temporarily swapped, so 'cd' or 'set -o' still take effect.
+
+// The forked child has no exec to drop CLOEXEC descriptors, so it closes
+// the pipeline's other pipe ends itself: a stray write end would keep its
+// own input from ever reaching EOF.
+static pid_t fork_builtin(char **argv, int in_fd, int out_fd, pid_t pgid,
+                          int (*pipes)[2], int npipes, const placement_t *place)
+{
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork failed");
+        return -1;
+    }
+    if (pid == 0) {
+        if (pgid >= 0) setpgid(0, pgid);
+        if (job_control) {
+            sigset_t def;
+            job_signals(&def);
+            for (int sig = 1; sig < NSIG; sig++)
+                if (sigismember(&def, sig) == 1) signal(sig, SIG_DFL);
+            signal(SIGINT, SIG_DFL);
+        }
+        // not the terminal owner: fg/bg/wait must not touch process groups
+        job_control = 0;
+        shell_interactive = 0;
+        if (in_fd >= 0 && in_fd != STDIN_FILENO && dup2(in_fd, STDIN_FILENO) < 0) { perror("dup2 <"); _exit(1); }
+        if (out_fd >= 0 && out_fd != STDOUT_FILENO && dup2(out_fd, STDOUT_FILENO) < 0) { perror("dup2 >"); _exit(1); }
+        for (int p = 0; p < npipes; p++) { close(pipes[p][0]); close(pipes[p][1]); }
+        if (in_fd > STDERR_FILENO) close(in_fd);
+        if (out_fd > STDERR_FILENO) close(out_fd);
+        if (place && apply_placement(place) < 0) _exit(126);
+        int rc = run_builtin(argv);
+        fflush(stdout);
+        _exit(rc);
+    }
+    return pid;
+}
+
+// Move fd onto target for the duration of a builtin; returns the saved
+// copy of target (-1 if target was closed, -2 if nothing was moved)
+static int swap_fd(int fd, int target)
+{
+    if (fd < 0 || fd == target) return -2;
+    int saved = fcntl(target, F_DUPFD_CLOEXEC, 10);
+    if (dup2(fd, target) < 0) {
+        perror("dup2");
+        if (saved >= 0) close(saved);
+        return -2;
+    }
+    return saved;
+}
+
+static void restore_fd(int saved, int target)
+{
+    if (saved == -2) return;
+    if (saved == -1) { close(target); return; }
+    dup2(saved, target);
+    close(saved);
+}
+
+static void on_sigpipe(int sig)
+{
+    (void)sig;
+}
+
+// Run a builtin in the shell process with its own redirections on top of
+// in_fd/out_fd (-1 = the shell's own stdin/stdout). Returns exit status.
+// Writing into a pipe whose reader is gone (e.g. a coprocess that exited)
+// fails with EPIPE instead of killing the shell; a handler rather than
+// SIG_IGN, so whatever the builtin starts gets the default back at exec.
+static int run_builtin_here(const stage_t *st, int in_fd, int out_fd)
+{
+    int rin, rout;
+    if (open_redirs(st, &rin, &rout) < 0) return 1;
+    if (rin >= 0) in_fd = rin;
+    if (rout >= 0) out_fd = rout;
+    fflush(stdout);
+    int saved_in = swap_fd(in_fd, STDIN_FILENO);
+    int saved_out = swap_fd(out_fd, STDOUT_FILENO);
+    struct sigaction sa = { .sa_handler = on_sigpipe }, old_sa;
+    if (saved_out != -2) sigaction(SIGPIPE, &sa, &old_sa);
+    int rc = run_builtin(st->argv);
+    fflush(stdout);
+    if (saved_out != -2) sigaction(SIGPIPE, &old_sa, NULL);
+    restore_fd(saved_out, STDOUT_FILENO);
+    restore_fd(saved_in, STDIN_FILENO);
+    if (rin >= 0) close(rin);
+    if (rout >= 0) close(rout);
+    return rc;
+}
+
+// Tail position: the shell has nothing left to do after this command, so
+// it becomes the command instead of forking and waiting for it. Returns
+// only if the command cannot be run; the shell then reports it as usual.
+static int exec_in_place(const stage_t *st, const placement_t *place)
+{
+    const char *path = path_lookup(st->argv[0]);
+    if (!path) return 0;
+    int rin, rout;
+    if (open_redirs(st, &rin, &rout) < 0) return 1;
+    out_flush();
+    fflush(stdout);
+    fflush(stderr);
+    if (rin >= 0) dup2(rin, STDIN_FILENO);
+    if (rout >= 0) dup2(rout, STDOUT_FILENO);
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, NULL);
+    if (place && apply_placement(place) < 0) _exit(126);
+    if (opt_xtrace) trace_event('i', "exec", 0, trace_now(), 0, -1, path);
+    char **envp = shell_envp();
+    execve(path, st->argv, envp);
+    if (errno == ENOEXEC) {
+        char *shv[argv_count(st->argv) + 2];
+        execve("/bin/sh", sh_argv(shv, path, st->argv), envp);
+    }
+    int err = errno;
+    perror(st->argv[0]);
+    _exit(err == ENOENT ? 127 : 126);
+}
+
+// Launch one stage with stdin/stdout wired to in_fd/out_fd (-1 = inherit)
+// into process group pgid (-1 = the shell's, 0 = a new one led by the
+// child). Returns the child pid, 0 if the command could not be executed,
+// -1 if the shell itself failed (fork/spawn resources). pipes lists every
+// pipe of the pipeline, for builtins that run in a plain fork. A placed
+// stage (place != NULL) always forks: posix_spawn cannot set it up.
+//
+// With xtrace, the fork or spawn call is a span on the shell's row and the
+// child's row opens with its command. posix_spawn returns once the child
+// has exec'd, so its return is the exec event of a spawned stage.
+static pid_t launch_stage(char **argv, int in_fd, int out_fd, pid_t pgid,
+                          int (*pipes)[2], int npipes, const placement_t *place)
+{
+    uint64_t t0 = opt_xtrace ? trace_now() : 0;
+    if (is_builtin(argv[0])) {
+        pid_t pid = fork_builtin(argv, in_fd, out_fd, pgid, pipes, npipes, place);
+        if (pid > 0 && pgid >= 0)
+            setpgid(pid, pgid ? pgid : pid);
+        if (opt_xtrace && pid > 0) {
+            trace_event('X', "fork", 0, t0, trace_now() - t0, -1, argv[0]);
+            trace_event('B', "builtin", pid, t0, 0, -1, argv[0]);
+        }
+        return pid;
+    }
+    // PATH search goes through the command hash instead of execvp()
+    const char *path = path_lookup(argv[0]);
+    if (!path) {
+        fprintf(stderr, "Command not found: %s\n", argv[0]);
+        return 0;
+    }
+    int spawned = opt_spawn && !place;
+    pid_t pid = spawned ? spawn_stage(path, argv, in_fd, out_fd, pgid)
+                        : fork_stage(path, argv, in_fd, out_fd, pgid, place);
+    // also set the group from the parent so no later stage can race it
+    if (pid > 0 && pgid >= 0)
+        setpgid(pid, pgid ? pgid : pid);
+    if (opt_xtrace && pid > 0) {
+        uint64_t t1 = trace_now();
+        trace_event('X', spawned ? "spawn" : "fork", 0, t0, t1 - t0, -1, argv[0]);
+        trace_event('B', "process", pid, t0, 0, -1, argv[0]);
+        if (spawned) trace_event('i', "exec", pid, t1, 0, -1, path);
+    }
+    return pid;
+}
 
-    // Parse tokens into pipeline stages and per-stage redirections
-    typedef struct {
-        char *argv[MAXARGS + 1];
-        char *infile;
-        char *outfile;
-    } stage_t;
+// Print the 'time' report: one line per stage for pipelines, then the total
+static void report_times(const job_t *j)
+{
+    if (j->nprocs > 1) {
+        for (int k = 0; k < j->nprocs; k++) {
+            char label[32];
+            snprintf(label, sizeof(label), "[%d] %d", k + 1, (int)j->procs[k].pid);
+            print_times(stderr, label, j->procs[k].wall, &j->procs[k].ru);
+        }
+    }
+    struct rusage total;
+    job_rusage(j, &total);
+    print_times(stderr, "total", elapsed_since(&j->start), &total);
+}
+
+typedef struct {
+    stage_t *stages;
+    int      nst;
+    long     pipesize;  // F_SETPIPE_SZ for the pipes between stages (0 = default)
+    placement_t place;  // 'affinity'/'nice'/'ulimit' prefixes, for every stage
+} pipeline_t;
+
+// The placement of one stage: the pipeline's, with the stage's own CPUs
+// if it has any. NULL if there is nothing to apply.
+static const placement_t* stage_placement(const pipeline_t *pl, const stage_t *st, placement_t *buf)
+{
+    if (!st->has_cpus)
+        return placement_active(&pl->place) ? &pl->place : NULL;
+    *buf = pl->place;
+    buf->has_cpus = 1;
+    buf->cpus = st->cpus;
+    return buf;
+}
+
+// Parse tokens into pipeline stages and per-stage redirections. Each
+// stage's argv is compacted in place inside arglist: operator and file
+// tokens always occupy at least as many slots as they leave behind (a NULL
+// terminator), so the write index never passes the read index. Operators
+// are the parser's words (syntax_word()): text alone never makes one.
+// Returns 0, or the exit status of the failure (2 = syntax error).
+static int parse_pipeline(char **arglist, pipeline_t *pl)
+{
+    // Size the pipeline: one stage per '|' plus one
+    int max_st = 1;
+    for (int i = 0; arglist[i] != NULL; i++)
+        if (syntax_word(arglist[i]) == SYN_PIPE) max_st++;
+
+    pl->nst = 0;
+    pl->pipesize = opt_pipesize;
+    memset(&pl->place, 0, sizeof(pl->place));
+    pl->stages = (stage_t*)calloc((size_t)max_st, sizeof(stage_t));
+    if (!pl->stages) { perror("calloc"); return 1; }
+    stage_t *stages = pl->stages;
 
-    stage_t stages[MAXARGS]; // upper bound; practical pipelines are small
     int nst = 0;
     int argc = 0;
-
-    // init first stage
-    memset(&stages[0], 0, sizeof(stage_t));
+    int w = 0;
+    stages[0].argv = arglist;
 
     for (int i = 0; arglist[i] != NULL; i++) {
         char *t = arglist[i];
-        if (strcmp(t, "|") == 0) {
+        int syn = syntax_word(t);
+        if (syn != SYN_NONE && syn < SYN_TIME && syn != SYN_PIPE && arglist[i+1] == NULL) {
+            fprintf(stderr, "myshell: syntax error near unexpected token '%s'\n", t);
+            return 2;
+        }
+        if (syn == SYN_PIPE) {
             if (argc == 0) {
                 fprintf(stderr, "myshell: invalid null command\n");
-                return 0;
+                return 2;
             }
-            stages[nst].argv[argc] = NULL;
+            arglist[w++] = NULL;
             nst++;
-            if (nst >= MAXARGS) {
-                fprintf(stderr, "myshell: pipeline too long\n");
-                return 0;
-            }
-            memset(&stages[nst], 0, sizeof(stage_t));
+            stages[nst].argv = &arglist[w];
             argc = 0;
-        } else if (strcmp(t, "<") == 0) {
-            if (arglist[i+1] == NULL) {
-                fprintf(stderr, "myshell: syntax error near unexpected token '<'\n");
-                return 0;
-            }
+        } else if (syn == SYN_LESS) {
             stages[nst].infile = arglist[++i];
-        } else if (strcmp(t, ">") == 0) {
-            if (arglist[i+1] == NULL) {
-                fprintf(stderr, "myshell: syntax error near unexpected token '>'\n");
-                return 0;
+            stages[nst].heredoc = NULL;
+            stages[nst].infd = NULL;
+        } else if (syn == SYN_LESSAND || syn == SYN_GREATAND) {
+            if (syn == SYN_LESSAND) {
+                stages[nst].infd = arglist[++i];
+                stages[nst].infile = stages[nst].heredoc = NULL;
+            } else {
+                stages[nst].outfd = arglist[++i];
+                stages[nst].outfile = NULL;
             }
+        } else if (syn == SYN_DLESS || syn == SYN_TLESS) {
+            stages[nst].heredoc = arglist[++i];
+            stages[nst].heredoc_nl = syn == SYN_TLESS;
+            stages[nst].infile = stages[nst].infd = NULL;
+        } else if (syn == SYN_GREAT) {
             stages[nst].outfile = arglist[++i];
-        } else {
-            if (argc < MAXARGS) {
-                stages[nst].argv[argc++] = t;
+            stages[nst].outfd = NULL;
+        } else if (syn == SYN_AT) {
+            // the '@CPUS' word follows; past the command name it is an argument
+            t = arglist[++i];
+            if (argc == 0 && !stages[nst].has_cpus) {
+                if (parse_cpus(t + 1, &stages[nst].cpus) < 0) {
+                    fprintf(stderr, "myshell: %s: invalid CPU list\n", t);
+                    return 2;
+                }
+                stages[nst].has_cpus = 1;
+            } else {
+                arglist[w++] = t;
+                argc++;
             }
+        } else {
+            arglist[w++] = t;
+            argc++;
         }
     }
+    arglist[w] = NULL;
 
-    if (argc > 0) {
-        stages[nst].argv[argc] = NULL;
+    if (argc > 0)
         nst++;
-    }
+    pl->nst = nst;
+    return 0;
+}
 
-    if (nst == 0)
-        return 0;
+// Start every stage of a parsed pipeline as one job, without waiting.
+// stdin_fd / out_fd (if >= 0) replace the first stage's stdin / the last
+// stage's stdout unless it has its own redirection. With builtin_here set,
+// a builtin last stage runs in the shell before this returns. *last gets
+// the last stage's exit status when it is already known (127 or 126 if it
+// could not run, or the in-process builtin's status) and stays -1
+// otherwise. Returns NULL (after cleaning up) if no process is left.
+static job_t* launch_pipeline(pipeline_t *pl, const char *raw_cmd, int foreground,
+                              int use_pgrp, int stdin_fd, int out_fd, int builtin_here, int *last)
+{
+    stage_t *stages = pl->stages;
+    int nst = pl->nst;
+    placement_t pbuf;
+    // a placed builtin needs a process of its own to place
+    int here = builtin_here && is_builtin(stages[nst-1].argv[0]) &&
+               !stage_placement(pl, &stages[nst-1], &pbuf);
 
-    // No pipe: handle possible builtin and redirections
-    if (nst == 1) {
-        if (handle_builtin(stages[0].argv))
-            return 0;
+    // Flush pending stdio output so a forked child cannot duplicate it
+    fflush(stdout);
 
-        pid_t cpid = fork();
-        if (cpid < 0) {
-            perror("fork failed");
-            return 0;
-        }
-        if (cpid == 0) {
-            // child: setup redirections
-            if (stages[0].infile) {
-                int fd = open(stages[0].infile, O_RDONLY);
-                if (fd < 0) { perror("open <"); _exit(1); }
-                if (dup2(fd, STDIN_FILENO) < 0) { perror("dup2 <"); _exit(1); }
-                close(fd);
-            }
-            if (stages[0].outfile) {
-                int fd = open(stages[0].outfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-                if (fd < 0) { perror("open >"); _exit(1); }
-                if (dup2(fd, STDOUT_FILENO) < 0) { perror("dup2 >"); _exit(1); }
-                close(fd);
-            }
-            execvp(stages[0].argv[0], stages[0].argv);
-            perror("Command not found");
-            _exit(1);
-        }
-        if (background) {
-            add_job(cpid, raw_cmd);
-        } else {
-            int status;
-            waitpid(cpid, &status, 0);
-        }
-        return 0;
-    }
+    job_t *job = job_create(raw_cmd, foreground);
+    if (!job) { *last = 1; return NULL; }
+    job->use_pgrp = use_pgrp;
+    job->place = placement_describe(&pl->place);
 
-    // Pipeline of nst stages
+    // Pipeline of nst stages (nst == 1 is a plain command). Pipe ends are
+    // CLOEXEC so every child only keeps the two ends dup2()ed onto 0/1.
     int num_pipes = nst - 1;
-    int pipes_arr[MAXARGS][2];
+    int (*pipes_arr)[2] = NULL;
+    if (num_pipes > 0) {
+        pipes_arr = (int (*)[2])malloc((size_t)num_pipes * sizeof(*pipes_arr));
+        if (!pipes_arr) { perror("malloc"); job_remove(job); *last = 1; return NULL; }
+    }
     for (int p = 0; p < num_pipes; p++) {
-        if (pipe(pipes_arr[p]) < 0) {
+        if (pipe2(pipes_arr[p], O_CLOEXEC) < 0) {
             perror("pipe");
             // close any previously created
             for (int q = 0; q < p; q++) { close(pipes_arr[q][0]); close(pipes_arr[q][1]); }
-            return 0;
+            free(pipes_arr);
+            job_remove(job);
+            *last = 1;
+            return NULL;
         }
+        // Larger pipes mean fewer context switches per MB between stages.
+        // Failure (e.g. above /proc/sys/fs/pipe-max-size) keeps the default.
+        if (pl->pipesize > 0 && fcntl(pipes_arr[p][1], F_SETPIPE_SZ, (int)pl->pipesize) < 0 && p == 0)
+            fprintf(stderr, "myshell: pipesize %ld: %s\n", pl->pipesize, strerror(errno));
     }
 
-    pid_t pids[MAXARGS];
-    for (int si = 0; si < nst; si++) {
-        pid_t pid = fork();
+    int nchild = here ? nst - 1 : nst;
+    for (int si = 0; si < nchild; si++) {
+        // per-stage redirections override the pipe ends
+        int in_fd, red_out;
+        pid_t pid = 0;
+        launch_status = 127;
+        if (open_redirs(&stages[si], &in_fd, &red_out) == 0) {
+            int in = in_fd >= 0 ? in_fd : (si > 0 ? pipes_arr[si-1][0] : stdin_fd);
+            int out = red_out >= 0 ? red_out : (si < nst - 1 ? pipes_arr[si][1] : out_fd);
+            pid = launch_stage(stages[si].argv, in, out, use_pgrp ? job->pgid : -1,
+                               pipes_arr, num_pipes, stage_placement(pl, &stages[si], &pbuf));
+            if (in_fd >= 0) close(in_fd);
+            if (red_out >= 0) close(red_out);
+        }
         if (pid < 0) {
-            perror("fork");
             // parent cleanup: close all pipes
             for (int p = 0; p < num_pipes; p++) { close(pipes_arr[p][0]); close(pipes_arr[p][1]); }
-            // wait for any previously forked children
-            for (int k = 0; k < si; k++) waitpid(pids[k], NULL, 0);
-            return 0;
+            free(pipes_arr);
+            // wait for any previously launched children
+            if (job->nprocs) job_wait(job, 0);
+            job_remove(job);
+            *last = 1;
+            return NULL;
         }
-        if (pid == 0) {
-            // child
-            // connect stdin if not first
-            if (si > 0) {
-                if (dup2(pipes_arr[si-1][0], STDIN_FILENO) < 0) { perror("dup2 pipe in"); _exit(1); }
-            }
-            // connect stdout if not last
-            if (si < nst - 1) {
-                if (dup2(pipes_arr[si][1], STDOUT_FILENO) < 0) { perror("dup2 pipe out"); _exit(1); }
-            }
-            // close all pipe fds in child
-            for (int p = 0; p < num_pipes; p++) { close(pipes_arr[p][0]); close(pipes_arr[p][1]); }
+        if (pid > 0)
+            job_add_proc(job, pid);
+        else if (si == nst - 1)
+            *last = launch_status; // last stage could not run
+    }
 
-            // apply per-stage redirections (override pipe ends if specified)
-            if (stages[si].infile) {
-                int fd = open(stages[si].infile, O_RDONLY);
-                if (fd < 0) { perror("open <"); _exit(1); }
-                if (dup2(fd, STDIN_FILENO) < 0) { perror("dup2 <"); _exit(1); }
-                close(fd);
-            }
-            if (stages[si].outfile) {
-                int fd = open(stages[si].outfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-                if (fd < 0) { perror("open >"); _exit(1); }
-                if (dup2(fd, STDOUT_FILENO) < 0) { perror("dup2 >"); _exit(1); }
-                close(fd);
+    // parent: close all pipe fds (the in-process builtin keeps its input
+    // until it is done, so the writers see EOF/EPIPE as usual)
+    int keep = here && nst > 1 ? pipes_arr[nst-2][0] : -1;
+    for (int p = 0; p < num_pipes; p++) {
+        if (pipes_arr[p][0] != keep) close(pipes_arr[p][0]);
+        close(pipes_arr[p][1]);
+    }
+    free(pipes_arr);
+
+    if (here) {
+        *last = run_builtin_here(&stages[nst-1], keep, out_fd);
+        if (keep >= 0) close(keep);
+    }
+
+    if (job->nprocs == 0) {
+        job_remove(job);
+        return NULL;
+    }
+    return job;
+}
+
+// Start a pipeline given as tokens without waiting for it (used by
+// builtins that drive their own children, e.g. 'parallel'). The job is
+// hidden from 'jobs' and stays in the shell's process group; the caller
+// waits for it and removes it. A background one ('coproc') is a regular
+// job instead, in a process group of its own, listed and reaped like
+// 'cmd &'.
+job_t* spawn_pipeline(char **arglist, const char *raw_cmd, int in_fd, int out_fd,
+                      int background, int *rc)
+{
+    pipeline_t pl;
+    *rc = parse_pipeline(arglist, &pl);
+    job_t *job = NULL;
+    if (*rc == 0 && pl.nst > 0) {
+        int last = -1;
+        job = launch_pipeline(&pl, raw_cmd, !background, background, in_fd, out_fd, 0, &last);
+        if (!job) *rc = last > 0 ? last : 1;
+    }
+    free(pl.stages);
+    return job;
+}
+
+int execute(char* arglist[], int background, const char* raw_cmd) {
+    if (arglist == NULL || arglist[0] == NULL)
+        return 0;
+
+    // Prefixes, in any order: 'time' accounts for the whole pipeline and
+    // each stage; 'pipesize N' overrides the pipe capacity for this one;
+    // 'affinity', 'nice' and 'ulimit' place every stage
+    int timed = 0;
+    long pipesize = -1;
+    placement_t place;
+    memset(&place, 0, sizeof(place));
+    while (arglist[0]) {
+        int used;
+        int syn = syntax_word(arglist[0]);
+        if (syn == SYN_TIME) {
+            timed = 1;
+            arglist++;
+        } else if (syn == SYN_PIPESIZE) {
+            if (!arglist[1] || parse_size(arglist[1], &pipesize) < 0) {
+                fprintf(stderr, "myshell: pipesize: usage: pipesize N[K|M] cmd | cmd...\n");
+                return 2;
             }
+            arglist += 2;
+        } else if ((syn == SYN_AFFINITY || syn == SYN_NICE || syn == SYN_ULIMIT) &&
+                   (used = placement_prefix(arglist, &place)) != 0) {
+            if (used < 0) return 2;
+            arglist += used;
+        } else
+            break;
+    }
+    struct timespec t_start;
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
 
-            execvp(stages[si].argv[0], stages[si].argv);
-            perror("Command not found");
-            _exit(1);
-        } else {
-            pids[si] = pid;
+    job_t *job = NULL;
+    pipeline_t pl;
+    int rc = parse_pipeline(arglist, &pl);
+    if (rc != 0)
+        goto done;
+    if (pipesize >= 0)
+        pl.pipesize = pipesize;
+    pl.place = place;
+
+    if (pl.nst == 0) {
+        if (timed) print_times(stderr, "total", 0.0, &(struct rusage){0});
+        goto done;
+    }
+
+    // A lone builtin runs in the shell, redirections included (timed
+    // in-process via RUSAGE_SELF), unless it is placed
+    placement_t pbuf;
+    const placement_t *place0 = stage_placement(&pl, &pl.stages[0], &pbuf);
+    if (pl.nst == 1 && is_builtin(pl.stages[0].argv[0]) && !place0) {
+        struct rusage before, after;
+        if (timed) getrusage(RUSAGE_SELF, &before);
+        uint64_t t0 = opt_xtrace ? trace_now() : 0;
+        rc = run_builtin_here(&pl.stages[0], -1, -1);
+        if (opt_xtrace && t0) trace_event('X', "builtin", 0, t0, trace_now() - t0, rc, pl.stages[0].argv[0]);
+        if (timed) {
+            getrusage(RUSAGE_SELF, &after);
+            timersub(&after.ru_utime, &before.ru_utime, &after.ru_utime);
+            timersub(&after.ru_stime, &before.ru_stime, &after.ru_stime);
+            print_times(stderr, "total", elapsed_since(&t_start), &after);
         }
+        goto done;
     }
 
-    // parent: close all pipe fds
-    for (int p = 0; p < num_pipes; p++) { close(pipes_arr[p][0]); close(pipes_arr[p][1]); }
+    if (exec_tail && !background && !timed && pl.nst == 1) {
+        rc = exec_in_place(&pl.stages[0], place0);
+        if (rc != 0) goto done;
+    }
+
+    // Every pipeline is a job. Background jobs (and, with job control, all
+    // jobs) run in their own process group led by the first stage. A
+    // builtin at the end of a foreground pipeline runs in the shell.
+    int last = -1;
+    job = launch_pipeline(&pl, raw_cmd, !background, background || job_control, -1, -1,
+                          !background, &last);
+    if (job) procsub_adopt(job);
+    if (!job) {
+        rc = last > 0 ? last : 0;
+        goto done;
+    }
 
     if (background) {
-        // Track only the last stage's pid for simplicity (could track all)
-        add_job(pids[nst - 1], raw_cmd);
+        // every stage is tracked; the job is reported once all have exited
+        if (shell_interactive)
+            printf("[%d] %d\n", job->id, (int)job->pgid);
+        job = NULL; // owned by the job table now
     } else {
-        // wait for all children
-        for (int si = 0; si < nst; si++) {
-            int status;
-            waitpid(pids[si], &status, 0);
-        }
+        // Wait for all stages in whatever order they exit. Any other child
+        // reaped meanwhile is routed to its own job instead of being lost.
+        int code = job_wait(job, 1);
+        rc = last >= 0 ? last : code;
+        if (timed)
+            report_times(job);
+        if (job->state == JOB_STOPPED)
+            job = NULL; // listed by 'jobs' now; resume with fg/bg
     }
-    return 0;
-}
-
 
-  
+done:
+    if (job) job_remove(job);
+    free(pl.stages);
+    return rc;
+}
@@ -0,0 +1,349 @@
+#include "shell.h"
+#include <dirent.h>
+#include <limits.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+/* ------------ Pathname expansion ------------ */
+// Words with an unquoted '*', '?' or '[' are matched against the file
+// system when they expand; the lexer has put a '\' before every character
+// of the word that must match literally (quoted ones, '\' itself). Each
+// directory is read once per command line into a sorted listing that all
+// patterns on the line share; a listing is re-read only if the directory
+// changed since (a command on the same line created a file). A pattern's
+// literal prefix narrows the scan to one binary-searched range of the
+// listing, so 'access.*' in a directory of 100k files compares only the
+// names starting with "access.".
+
+typedef struct {
+    const char   *name;
+    unsigned char type;   // d_type
+} gent_t;
+
+typedef struct {
+    char           *path;   // as used in the pattern, e.g. "src/" ("" = cwd)
+    struct timespec mtime, ctime;
+    off_t           size;
+    gent_t         *ents;   // sorted by name
+    size_t          n;
+    char           *pool;   // the names
+} gdir_t;
+
+static gdir_t *gdirs = NULL;
+static size_t  ngdirs = 0, gdirs_cap = 0;
+
+static void gdir_free(gdir_t *d)
+{
+    free(d->ents);
+    free(d->pool);
+    d->ents = NULL;
+    d->pool = NULL;
+    d->n = 0;
+}
+
+// Forget every listing; run_source() calls this after each command line
+void glob_cache_clear(void)
+{
+    for (size_t i = 0; i < ngdirs; i++) {
+        gdir_free(&gdirs[i]);
+        free(gdirs[i].path);
+    }
+    ngdirs = 0;
+}
+
+static int gent_cmp(const void *a, const void *b)
+{
+    return strcmp(((const gent_t*)a)->name, ((const gent_t*)b)->name);
+}
+
+static int read_dir(gdir_t *d)
+{
+    DIR *dp = opendir(*d->path ? d->path : ".");
+    if (!dp) return -1;
+    size_t cap = 256, pool_cap = 4096, pool_len = 0;
+    d->ents = (gent_t*)malloc(cap * sizeof(gent_t));
+    d->pool = (char*)malloc(pool_cap);
+    d->n = 0;
+    if (!d->ents || !d->pool) { perror("malloc"); closedir(dp); gdir_free(d); return -1; }
+    struct dirent *de;
+    while ((de = readdir(dp)) != NULL) {
+        if (de->d_name[0] == '.' && (!de->d_name[1] || (de->d_name[1] == '.' && !de->d_name[2])))
+            continue; // never matched, not even by '.*'
+        size_t len = strlen(de->d_name) + 1;
+        if (d->n == cap || pool_len + len > pool_cap) {
+            if (d->n == cap) cap *= 2;
+            while (pool_len + len > pool_cap) pool_cap *= 2;
+            gent_t *ne = (gent_t*)realloc(d->ents, cap * sizeof(gent_t));
+            if (ne) d->ents = ne;
+            char *np = ne ? (char*)realloc(d->pool, pool_cap) : NULL;
+            if (!np) { perror("realloc"); closedir(dp); gdir_free(d); return -1; }
+            d->pool = np;
+        }
+        memcpy(d->pool + pool_len, de->d_name, len);
+        // an offset until the pool stops moving
+        d->ents[d->n++] = (gent_t){ (const char*)(uintptr_t)pool_len, de->d_type };
+        pool_len += len;
+    }
+    closedir(dp);
+    for (size_t i = 0; i < d->n; i++) d->ents[i].name = d->pool + (uintptr_t)d->ents[i].name;
+    qsort(d->ents, d->n, sizeof(gent_t), gent_cmp);
+    return 0;
+}
+
+// The listing of directory path (ending in '/', or "" for the cwd)
+static const gdir_t* dir_listing(const char *path)
+{
+    struct stat sb;
+    if (stat(*path ? path : ".", &sb) < 0 || !S_ISDIR(sb.st_mode)) return NULL;
+    gdir_t *d = NULL;
+    for (size_t i = 0; i < ngdirs && !d; i++)
+        if (strcmp(gdirs[i].path, path) == 0) d = &gdirs[i];
+    if (d) {
+        if (d->mtime.tv_sec == sb.st_mtim.tv_sec && d->mtime.tv_nsec == sb.st_mtim.tv_nsec &&
+            d->ctime.tv_sec == sb.st_ctim.tv_sec && d->ctime.tv_nsec == sb.st_ctim.tv_nsec &&
+            d->size == sb.st_size)
+            return d;
+        gdir_free(d);
+    } else {
+        if (ngdirs == gdirs_cap) {
+            size_t ncap = gdirs_cap ? gdirs_cap * 2 : 8;
+            gdir_t *nd = (gdir_t*)realloc(gdirs, ncap * sizeof(gdir_t));
+            if (!nd) { perror("realloc"); return NULL; }
+            gdirs = nd;
+            gdirs_cap = ncap;
+        }
+        d = &gdirs[ngdirs];
+        memset(d, 0, sizeof(*d));
+        if (!(d->path = strdup(path))) { perror("strdup"); return NULL; }
+        ngdirs++;
+    }
+    d->mtime = sb.st_mtim;
+    d->ctime = sb.st_ctim;
+    d->size = sb.st_size;
+    return read_dir(d) == 0 ? d : NULL;
+}
+
+/* ------------ Matching ------------ */
+// '[...]' at p against c: sets *ok, returns the position after ']' (NULL
+// if the class is not closed, and '[' is then an ordinary character)
+static const char* match_class(const char *p, unsigned char c, int *ok)
+{
+    const char *q = p + 1;
+    int neg = *q == '!' || *q == '^';
+    if (neg) q++;
+    int found = 0;
+    for (int first = 1; *q && (first || *q != ']'); first = 0) {
+        unsigned char lo = (unsigned char)*q;
+        if (lo == '\\' && q[1]) lo = (unsigned char)*++q;
+        q++;
+        unsigned char hi = lo;
+        if (*q == '-' && q[1] && q[1] != ']') {
+            q++;
+            hi = (unsigned char)*q;
+            if (hi == '\\' && q[1]) hi = (unsigned char)*++q;
+            q++;
+        }
+        if (c >= lo && c <= hi) found = 1;
+    }
+    if (*q != ']') return NULL;
+    *ok = found != neg;
+    return q + 1;
+}
+
+// Whole-name match: '*' any run, '?' one character, '[...]' a class ('!'
+// or '^' negates, a-z ranges), '\' quotes the next character. Iterative:
+// on a mismatch, retry after the last '*' with one more character eaten.
+static int match(const char *p, const char *s)
+{
+    const char *star_p = NULL, *star_s = NULL;
+    for (;;) {
+        if (*p == '*') {
+            while (*p == '*') p++;
+            if (!*p) return 1;
+            star_p = p;
+            star_s = s;
+            continue;
+        }
+        if (!*s) return !*p;
+        int ok = 0;
+        const char *np;
+        if (*p == '?') {
+            ok = 1;
+            np = p + 1;
+        } else if (!(*p == '[' && (np = match_class(p, (unsigned char)*s, &ok)))) {
+            const char *c = p;
+            if (*c == '\\' && c[1]) c++;
+            ok = *c && *c == *s;
+            np = c + 1;
+        }
+        if (ok) {
+            p = np;
+            s++;
+            continue;
+        }
+        if (!star_p) return 0;
+        p = star_p;
+        s = ++star_s;
+    }
+}
+
+// Has an unquoted '*', '?' or '[' in its first n bytes
+static int has_magic(const char *s, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (s[i] == '\\' && i + 1 < n) i++;
+        else if (s[i] == '*' || s[i] == '?' || s[i] == '[') return 1;
+    }
+    return 0;
+}
+
+// Copy the first n bytes of s without their quoting '\'s; returns the length
+static size_t unescape_n(char *dst, const char *s, size_t n)
+{
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (s[i] == '\\' && i + 1 < n) i++;
+        dst[k++] = s[i];
+    }
+    return k;
+}
+
+/* ------------ Expansion ------------ */
+typedef struct {
+    arena_t *a;
+    char   **v;
+    size_t   n, cap;
+    char     path[PATH_MAX];  // directory part matched so far
+} gctx_t;
+
+static void add_match(gctx_t *g, size_t len)
+{
+    if (g->n == g->cap) {
+        size_t ncap = g->cap ? g->cap * 2 : 16;
+        char **nv = (char**)realloc(g->v, ncap * sizeof(char*));
+        if (!nv) { perror("realloc"); return; }
+        g->v = nv;
+        g->cap = ncap;
+    }
+    char *s = arena_strndup(g->a, g->path, len);
+    if (s) g->v[g->n++] = s;
+}
+
+// A directory, or a link to one (path: where e is)
+static int is_dir_ent(const char *path, const gent_t *e)
+{
+    if (e->type == DT_DIR) return 1;
+    if (e->type != DT_LNK && e->type != DT_UNKNOWN) return 0;
+    struct stat sb;
+    return stat(path, &sb) == 0 && S_ISDIR(sb.st_mode);
+}
+
+// Match the components of rest below g->path[0..len)
+static void walk(gctx_t *g, size_t len, const char *rest)
+{
+    const char *slash = strchr(rest, '/');
+    size_t clen = slash ? (size_t)(slash - rest) : strlen(rest);
+    const char *next = slash ? slash + 1 : NULL;
+    while (next && *next == '/') next++;
+
+    if (!has_magic(rest, clen)) {
+        if (len + clen + 2 > sizeof(g->path)) return;
+        size_t nlen = len + unescape_n(g->path + len, rest, clen);
+        g->path[nlen] = '\0';
+        if (next && *next) {
+            g->path[nlen++] = '/';
+            walk(g, nlen, next);
+            return;
+        }
+        struct stat sb;
+        if (lstat(nlen ? g->path : ".", &sb) == 0) {
+            if (next) g->path[nlen++] = '/'; // pattern ended in '/'
+            add_match(g, nlen);
+        }
+        return;
+    }
+
+    g->path[len] = '\0';
+    const gdir_t *d = dir_listing(g->path);
+    if (!d) return;
+    // deeper levels may move gdirs[], not the listing itself
+    const gent_t *ents = d->ents;
+    size_t nents = d->n;
+    // literal prefix: only names in that range of the sorted listing
+    char prefix[NAME_MAX + 1];
+    size_t plen = 0;
+    for (size_t i = 0; i < clen && plen < NAME_MAX; i++) {
+        if (rest[i] == '*' || rest[i] == '?' || rest[i] == '[') break;
+        if (rest[i] == '\\' && i + 1 < clen) i++;
+        prefix[plen++] = rest[i];
+    }
+    prefix[plen] = '\0';
+    int dot = plen > 0 && prefix[0] == '.';  // leading '.' only matched literally
+    size_t lo = 0, hi = nents;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (strcmp(ents[mid].name, prefix) < 0) lo = mid + 1; else hi = mid;
+    }
+    char comp[NAME_MAX * 2 + 2];
+    if (clen >= sizeof(comp)) return;
+    memcpy(comp, rest, clen);
+    comp[clen] = '\0';
+    for (size_t i = lo; i < nents && strncmp(ents[i].name, prefix, plen) == 0; i++) {
+        const gent_t *e = &ents[i];
+        if ((e->name[0] == '.' && !dot) || !match(comp, e->name)) continue;
+        size_t nlen = strlen(e->name);
+        if (len + nlen + 2 > sizeof(g->path)) continue;
+        memcpy(g->path + len, e->name, nlen + 1);
+        if (!next) {
+            add_match(g, len + nlen);
+        } else if (is_dir_ent(g->path, e)) {
+            g->path[len + nlen] = '/';
+            if (*next) walk(g, len + nlen + 1, next);
+            else add_match(g, len + nlen + 1); // 'dir*/'
+        }
+    }
+}
+
+static int str_cmp(const void *a, const void *b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// Does the (escaped) word need matching at all
+int glob_pattern(const char *s)
+{
+    return has_magic(s, strlen(s));
+}
+
+// Paths matching pattern, sorted, in arena a: a malloc'd array (NULL and
+// *n = 0 if nothing matches)
+char** glob_expand(const char *pattern, arena_t *a, size_t *n)
+{
+    gctx_t *g = (gctx_t*)malloc(sizeof(gctx_t));
+    if (!g) { perror("malloc"); *n = 0; return NULL; }
+    g->a = a;
+    g->v = NULL;
+    g->n = g->cap = 0;
+    size_t len = 0;
+    if (*pattern == '/') g->path[len++] = '/';
+    while (*pattern == '/') pattern++;
+    walk(g, len, pattern);
+    // one directory's matches are already in order; across several the
+    // '/' would sort differently
+    if (g->n > 1 && strchr(pattern, '/'))
+        qsort(g->v, g->n, sizeof(char*), str_cmp);
+    char **v = g->v;
+    *n = g->n;
+    free(g);
+    return v;
+}
+
+// The word as written, when nothing matches it
+char* glob_unescape(const char *s, arena_t *a)
+{
+    size_t n = strlen(s);
+    char *d = (char*)arena_alloc(a, n + 1);
+    if (!d) return NULL;
+    d[unescape_n(d, s, n)] = '\0';
+    return d;
+}
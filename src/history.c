@@ -0,0 +1,219 @@
+#include "shell.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* ------------ Persistent history ------------ */
+// Interactive sessions append every command to $HISTFILE (default
+// ~/.myshell_history) with one O_APPEND write(), which the kernel performs
+// atomically, so concurrent sessions interleave whole lines.
+//
+// Nothing is parsed at startup: the file is mmap()ed and only the last
+// 'histsize' lines are handed to readline for editing, found by scanning
+// backwards from the end. The index behind 'history' and '!n' is built on
+// first use and afterwards extended only by the bytes appended since (by
+// this or any other session). It is a ring of the last 'histsize' line
+// offsets, so memory stays bounded however large the file grows, and an
+// entry is found in O(1) by its number (its line number in the file).
+
+#define HIST_DEFAULT 1000
+
+long opt_histsize = 0;          // 0 = HIST_DEFAULT
+
+static int    hist_fd = -1;
+static char  *hmap = NULL;      // the file up to hmap_len
+static size_t hmap_len = 0;
+
+static off_t *ring = NULL;      // start offsets of the newest entries
+static size_t ring_cap = 0;
+static size_t ring_first = 0;   // slot of the oldest kept entry
+static size_t ring_used = 0;
+static long   hist_total = 0;   // entries (lines) indexed so far
+static size_t indexed = 0;      // bytes of the file already scanned
+
+static size_t hist_cap(void)
+{
+    return opt_histsize > 0 ? (size_t)opt_histsize : HIST_DEFAULT;
+}
+
+// Map (or re-map) the file up to its current size
+static int hist_map(void)
+{
+    struct stat sb;
+    if (hist_fd < 0 || fstat(hist_fd, &sb) < 0) return -1;
+    size_t len = (size_t)sb.st_size;
+    if (len < indexed) {
+        // truncated behind our back: index it again from the start
+        ring_used = ring_first = 0;
+        hist_total = 0;
+        indexed = 0;
+    }
+    if (len == hmap_len || len == 0) return 0;
+    char *m = hmap ? (char*)mremap(hmap, hmap_len, len, MREMAP_MAYMOVE)
+                   : (char*)mmap(NULL, len, PROT_READ, MAP_SHARED, hist_fd, 0);
+    if (m == MAP_FAILED) { perror("history: mmap"); return -1; }
+    hmap = m;
+    hmap_len = len;
+    return 0;
+}
+
+static void ring_push(off_t off)
+{
+    if (ring_cap == 0) {
+        ring_cap = hist_cap();
+        ring = (off_t*)malloc(ring_cap * sizeof(off_t));
+        if (!ring) { perror("malloc"); ring_cap = 0; return; }
+    }
+    if (ring_used < ring_cap) {
+        ring[(ring_first + ring_used++) % ring_cap] = off;
+    } else {
+        ring[ring_first] = off; // overwrite the oldest
+        ring_first = (ring_first + 1) % ring_cap;
+    }
+}
+
+// Index whatever was appended to the file since the last call
+static void hist_sync(void)
+{
+    if (hist_map() < 0) return;
+    while (indexed < hmap_len) {
+        const char *nl = (const char*)memchr(hmap + indexed, '\n', hmap_len - indexed);
+        if (!nl) break; // a line still being written; wait for its '\n'
+        ring_push((off_t)indexed);
+        hist_total++;
+        indexed = (size_t)(nl - hmap) + 1;
+    }
+}
+
+void hist_init(void)
+{
+    const char *path = getenv("HISTFILE");
+    char buf[4096];
+    if (!path) {
+        const char *home = getenv("HOME");
+        if (!home) return;
+        snprintf(buf, sizeof(buf), "%s/.myshell_history", home);
+        path = buf;
+    }
+    if (*path == '\0') return; // HISTFILE= disables persistence
+    hist_fd = open(path, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+    if (hist_fd < 0) {
+        fprintf(stderr, "myshell: history: %s: %s\n", path, strerror(errno));
+        return;
+    }
+    stifle_history((int)hist_cap());
+    if (hist_map() < 0 || hmap_len == 0) return;
+
+    // hand the last histsize lines to readline, touching only the tail
+    size_t want = hist_cap(), found = 0;
+    size_t start = hmap_len;
+    if (start > 0 && hmap[start - 1] == '\n') start--; // final newline
+    while (found < want) {
+        const char *nl = (const char*)memrchr(hmap, '\n', start);
+        found++;
+        if (!nl) { start = 0; break; }
+        start = (size_t)(nl - hmap);
+        if (found == want) { start++; break; }
+    }
+    char *line = NULL;
+    size_t cap = 0;
+    for (size_t p = start; p < hmap_len; ) {
+        const char *nl = (const char*)memchr(hmap + p, '\n', hmap_len - p);
+        size_t e = nl ? (size_t)(nl - hmap) : hmap_len;
+        if (e - p + 1 > cap) {
+            cap = e - p + 1;
+            char *nb = (char*)realloc(line, cap);
+            if (!nb) { perror("realloc"); break; }
+            line = nb;
+        }
+        memcpy(line, hmap + p, e - p);
+        line[e - p] = '\0';
+        if (*line) add_history(line);
+        p = e + 1;
+    }
+    free(line);
+}
+
+void hist_add(const char *line)
+{
+    add_history(line);
+    if (hist_fd < 0) return;
+    size_t len = strlen(line);
+    char stackbuf[1024];
+    char *rec = len + 1 <= sizeof(stackbuf) ? stackbuf : (char*)malloc(len + 1);
+    if (!rec) { perror("malloc"); return; }
+    memcpy(rec, line, len);
+    rec[len] = '\n';
+    if (write_all(hist_fd, rec, len + 1) < 0)
+        perror("history: write");
+    if (rec != stackbuf) free(rec);
+}
+
+// 'set -o histsize N': the ring is rebuilt on next use, so a larger cap
+// brings back entries that had already been dropped
+void hist_set_size(void)
+{
+    stifle_history((int)hist_cap());
+    free(ring);
+    ring = NULL;
+    ring_cap = ring_first = ring_used = 0;
+    hist_total = 0;
+    indexed = 0;
+}
+
+// Entry n (1-based line number in the file), or NULL if unknown or trimmed.
+// Call hist_sync() first.
+static const char* hist_entry(long n, size_t *len)
+{
+    long oldest = hist_total - (long)ring_used + 1;
+    if (n < oldest || n > hist_total) return NULL;
+    off_t off = ring[(ring_first + (size_t)(n - oldest)) % ring_cap];
+    const char *s = hmap + off;
+    const char *nl = (const char*)memchr(s, '\n', hmap_len - (size_t)off);
+    *len = nl ? (size_t)(nl - s) : hmap_len - (size_t)off;
+    return s;
+}
+
+char* hist_get(long n)
+{
+    if (hist_fd < 0) {
+        HIST_ENTRY *he = n > 0 && n <= history_length ? history_get((int)n) : NULL;
+        return he ? strdup(he->line) : NULL;
+    }
+    size_t len;
+    hist_sync();
+    const char *s = hist_entry(n, &len);
+    return s ? strndup(s, len) : NULL;
+}
+
+// history [N]: the kept entries, or only the last N
+void history_print(long last)
+{
+    if (hist_fd < 0) {
+        // no history file: readline's in-memory list
+        HIST_ENTRY **list = history_list();
+        if (!list || history_length == 0) {
+            out_printf("(history empty)\n");
+            return;
+        }
+        int from = last > 0 && last < history_length ? history_length - (int)last : 0;
+        for (int i = from; list[i] != NULL; i++)
+            out_printf("%d  %s\n", i + history_base, list[i]->line);
+        return;
+    }
+    hist_sync();
+    if (ring_used == 0) {
+        out_printf("(history empty)\n");
+        return;
+    }
+    long from = hist_total - (long)ring_used + 1;
+    if (last > 0 && hist_total - last + 1 > from) from = hist_total - last + 1;
+    for (long n = from; n <= hist_total; n++) {
+        size_t len;
+        const char *s = hist_entry(n, &len);
+        if (!s) continue;
+        out_printf("%ld  ", n);
+        out_write(s, len);
+        out_write("\n", 1);
+    }
+}
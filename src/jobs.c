@@ -0,0 +1,558 @@
+#include "shell.h"
+#include <signal.h>
+#include <sys/signalfd.h>
+
+/* ------------ Job table ------------ */
+// Every launched pipeline is a job, foreground ones included, so each
+// child's exit status has exactly one owner. Jobs live in a growable slot
+// array (job number = slot + 1) with a LIFO free list, so creation and
+// removal are O(1). A pid -> job index (open addressing, backward-shift
+// deletion) routes every reaped status to its job in O(1).
+
+static job_t **job_slots = NULL;
+static int     job_cap = 0;
+static int     job_count = 0;
+static int    *free_ids = NULL;   // stack of free slot indices
+static int     free_top = 0;
+
+typedef struct {
+    pid_t  pid;    // 0 = empty
+    job_t *job;
+    int    proc;   // index into job->procs
+} pid_ent_t;
+
+static pid_ent_t *pid_tab = NULL;
+static size_t     pid_cap = 0;   // power of two
+static size_t     pid_used = 0;
+
+int job_control = 0;            // interactive: process groups own the terminal
+static pid_t shell_pgid = 0;
+volatile sig_atomic_t shell_interrupted = 0;
+
+static size_t pid_hash(pid_t pid)
+{
+    return ((size_t)pid * 2654435761u);
+}
+
+static pid_ent_t* pid_find(pid_t pid)
+{
+    if (pid_cap == 0) return NULL;
+    size_t mask = pid_cap - 1;
+    for (size_t i = pid_hash(pid) & mask; pid_tab[i].pid; i = (i + 1) & mask)
+        if (pid_tab[i].pid == pid) return &pid_tab[i];
+    return NULL;
+}
+
+static void pid_put(pid_t pid, job_t *job, int proc);
+
+static int pid_grow(void)
+{
+    size_t ocap = pid_cap;
+    pid_ent_t *old = pid_tab;
+    size_t ncap = pid_cap ? pid_cap * 2 : 64;
+    pid_tab = (pid_ent_t*)calloc(ncap, sizeof(pid_ent_t));
+    if (!pid_tab) { perror("calloc"); pid_tab = old; return -1; }
+    pid_cap = ncap;
+    pid_used = 0;
+    for (size_t i = 0; i < ocap; i++)
+        if (old[i].pid) pid_put(old[i].pid, old[i].job, old[i].proc);
+    free(old);
+    return 0;
+}
+
+static void pid_put(pid_t pid, job_t *job, int proc)
+{
+    if ((pid_used + 1) * 2 > pid_cap && pid_grow() < 0) return;
+    size_t mask = pid_cap - 1;
+    size_t i = pid_hash(pid) & mask;
+    while (pid_tab[i].pid && pid_tab[i].pid != pid) i = (i + 1) & mask;
+    if (!pid_tab[i].pid) pid_used++;
+    pid_tab[i].pid = pid;
+    pid_tab[i].job = job;
+    pid_tab[i].proc = proc;
+}
+
+static void pid_del(pid_t pid)
+{
+    pid_ent_t *e = pid_find(pid);
+    if (!e) return;
+    size_t mask = pid_cap - 1;
+    size_t i = (size_t)(e - pid_tab);
+    // backward-shift: pull later entries of the cluster into the hole
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (!pid_tab[j].pid) break;
+        size_t home = pid_hash(pid_tab[j].pid) & mask;
+        // move j into i unless its home lies cyclically in (i, j]
+        if ((j > i && (home <= i || home > j)) || (j < i && (home <= i && home > j))) {
+            pid_tab[i] = pid_tab[j];
+            i = j;
+        }
+    }
+    pid_tab[i].pid = 0;
+    pid_tab[i].job = NULL;
+    pid_used--;
+}
+
+job_t* job_create(const char *cmd, int foreground)
+{
+    if (free_top == 0) {
+        int ncap = job_cap ? job_cap * 2 : 16;
+        job_t **ns = (job_t**)realloc(job_slots, (size_t)ncap * sizeof(job_t*));
+        if (!ns) { perror("realloc"); return NULL; }
+        job_slots = ns;
+        int *nf = (int*)realloc(free_ids, (size_t)ncap * sizeof(int));
+        if (!nf) { perror("realloc"); return NULL; }
+        free_ids = nf;
+        // push new slots so the lowest number comes out first
+        for (int i = ncap - 1; i >= job_cap; i--) {
+            job_slots[i] = NULL;
+            free_ids[free_top++] = i;
+        }
+        job_cap = ncap;
+    }
+    job_t *j = (job_t*)calloc(1, sizeof(job_t));
+    if (!j) { perror("calloc"); return NULL; }
+    j->cmd = strdup(cmd ? cmd : "(unknown)");
+    if (!j->cmd) { perror("strdup"); free(j); return NULL; }
+    int slot = free_ids[--free_top];
+    j->id = slot + 1;
+    j->foreground = foreground;
+    j->state = JOB_RUNNING;
+    clock_gettime(CLOCK_MONOTONIC, &j->start);
+    job_slots[slot] = j;
+    job_count++;
+    return j;
+}
+
+int job_add_proc(job_t *j, pid_t pid)
+{
+    if (j->nprocs == j->proc_cap) {
+        int ncap = j->proc_cap ? j->proc_cap * 2 : 4;
+        proc_t *np = (proc_t*)realloc(j->procs, (size_t)ncap * sizeof(proc_t));
+        if (!np) { perror("realloc"); return -1; }
+        j->procs = np;
+        j->proc_cap = ncap;
+    }
+    proc_t *p = &j->procs[j->nprocs];
+    memset(p, 0, sizeof(*p));
+    p->pid = pid;
+    if (j->pgid == 0 && j->use_pgrp) j->pgid = pid;
+    pid_put(pid, j, j->nprocs);
+    j->nprocs++;
+    j->nlive++;
+    return 0;
+}
+
+// A process the job started for a stage's use (process substitution): it
+// is waited for with the job, but the stages keep the exit status
+int job_add_aux(job_t *j, pid_t pid)
+{
+    if (job_add_proc(j, pid) < 0) return -1;
+    j->procs[j->nprocs - 1].aux = 1;
+    return 0;
+}
+
+void job_remove(job_t *j)
+{
+    if (!j) return;
+    for (int i = 0; i < j->nprocs; i++)
+        if (!j->procs[i].done) pid_del(j->procs[i].pid);
+    job_slots[j->id - 1] = NULL;
+    free_ids[free_top++] = j->id - 1;
+    job_count--;
+    free(j->procs);
+    free(j->cmd);
+    free(j->place);
+    free(j);
+}
+
+job_t* job_by_pid(pid_t pid)
+{
+    pid_ent_t *e = pid_find(pid);
+    return e ? e->job : NULL;
+}
+
+// "%n", "n" or empty (most recent background job)
+job_t* job_by_spec(const char *spec)
+{
+    if (spec == NULL) {
+        for (int i = job_cap - 1; i >= 0; i--)
+            if (job_slots[i] && !job_slots[i]->foreground) return job_slots[i];
+        return NULL;
+    }
+    if (*spec == '%') spec++;
+    char *end = NULL;
+    long id = strtol(spec, &end, 10);
+    if (end == spec || *end != '\0' || id < 1 || id > job_cap) return NULL;
+    job_t *j = job_slots[id - 1];
+    return (j && !j->foreground) ? j : NULL;
+}
+
+// Exit status of a wait() status word, shell style
+int status_code(int status)
+{
+    if (WIFEXITED(status)) return WEXITSTATUS(status);
+    if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+    return 1;
+}
+
+// Route one wait4() result to the job that owns the pid
+void job_reaped(pid_t pid, int status, const struct rusage *ru)
+{
+    pid_ent_t *e = pid_find(pid);
+    if (!e) return; // not ours (already removed job)
+    job_t *j = e->job;
+    proc_t *p = &j->procs[e->proc];
+
+    if (WIFSTOPPED(status)) {
+        if (opt_xtrace) trace_event('i', "stopped", pid, trace_now(), 0, -1, NULL);
+        p->stopped = 1;
+        if (j->state != JOB_STOPPED) {
+            j->state = JOB_STOPPED;
+            j->notified = 0;
+        }
+        return;
+    }
+    if (WIFCONTINUED(status)) {
+        if (opt_xtrace) trace_event('i', "continued", pid, trace_now(), 0, -1, NULL);
+        p->stopped = 0;
+        return;
+    }
+
+    // closes the process's row opened at launch
+    if (opt_xtrace) trace_event('E', "exit", pid, trace_now(), 0, status_code(status), NULL);
+    p->done = 1;
+    p->stopped = 0;
+    p->status = status;
+    p->wall = elapsed_since(&j->start);
+    if (ru) p->ru = *ru;
+    pid_del(pid);
+    if (--j->nlive == 0) {
+        j->state = JOB_DONE;
+        j->notified = 0;
+        j->wall = p->wall;
+    }
+}
+
+// wait() status of the last stage (process substitutions come after it)
+static int last_stage_status(const job_t *j)
+{
+    for (int i = j->nprocs - 1; i >= 0; i--)
+        if (!j->procs[i].aux) return j->procs[i].status;
+    return 0;
+}
+
+// Exit status of a finished job: that of its last stage
+int job_exit_code(const job_t *j)
+{
+    return status_code(last_stage_status(j));
+}
+
+// Sum of the stages' usage (max RSS is the largest stage)
+void job_rusage(const job_t *j, struct rusage *total)
+{
+    memset(total, 0, sizeof(*total));
+    for (int i = 0; i < j->nprocs; i++) {
+        timeradd(&total->ru_utime, &j->procs[i].ru.ru_utime, &total->ru_utime);
+        timeradd(&total->ru_stime, &j->procs[i].ru.ru_stime, &total->ru_stime);
+        if (j->procs[i].ru.ru_maxrss > total->ru_maxrss) total->ru_maxrss = j->procs[i].ru.ru_maxrss;
+    }
+}
+
+// Block until the job finishes or stops, routing every other child reaped
+// meanwhile to its own job. With job control the job gets the terminal for
+// the duration of the wait.
+int job_wait(job_t *j, int give_terminal)
+{
+    if (give_terminal && job_control && j->pgid > 0)
+        tcsetpgrp(STDIN_FILENO, j->pgid);
+
+    uint64_t t0 = opt_xtrace ? trace_now() : 0;
+    while (j->state == JOB_RUNNING) {
+        int status;
+        struct rusage ru;
+        pid_t pid = wait4(-1, &status, job_control ? WUNTRACED : 0, &ru);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            break; // ECHILD: nothing left to wait for
+        }
+        job_reaped(pid, status, &ru);
+    }
+    if (opt_xtrace && t0)
+        trace_event('X', "wait", 0, t0, trace_now() - t0,
+                    j->state == JOB_STOPPED ? -1 : job_exit_code(j), j->cmd);
+
+    if (give_terminal && job_control && j->pgid > 0)
+        tcsetpgrp(STDIN_FILENO, shell_pgid);
+
+    if (j->state == JOB_STOPPED) {
+        // a stopped foreground pipeline becomes a regular listed job
+        j->foreground = 0;
+        j->notified = 1;
+        printf("\n[%d] %d  Stopped  %s\n", j->id, (int)j->pgid, j->cmd);
+        fflush(stdout);
+        return 128 + SIGTSTP;
+    }
+    return job_exit_code(j);
+}
+
+static void on_sigint(int sig)
+{
+    (void)sig;
+    shell_interrupted = 1;
+}
+
+// Interactive shells own the terminal and put every pipeline in its own
+// process group, so ^C/^Z reach the job and not the shell. A ^C that does
+// reach the shell (at the prompt, or while a builtin runs children in the
+// shell's group) only sets shell_interrupted; exec resets the handler.
+void job_control_init(void)
+{
+    if (!isatty(STDIN_FILENO)) return;
+    // wait until we are in the foreground
+    while (tcgetpgrp(STDIN_FILENO) != (shell_pgid = getpgrp()))
+        kill(-shell_pgid, SIGTTIN);
+    signal(SIGTSTP, SIG_IGN);
+    signal(SIGTTIN, SIG_IGN);
+    signal(SIGTTOU, SIG_IGN);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigint;  // no SA_RESTART: poll() at the prompt wakes up
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    shell_pgid = getpid();
+    if (getpgrp() != shell_pgid && setpgid(0, shell_pgid) < 0) {
+        perror("setpgid");
+        return;
+    }
+    tcsetpgrp(STDIN_FILENO, shell_pgid);
+    job_control = 1;
+}
+
+double elapsed_since(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static double tv_secs(const struct timeval *tv)
+{
+    return (double)tv->tv_sec + tv->tv_usec / 1e6;
+}
+
+#define TIMES_FMT "%-10s real %8.3fs  user %8.3fs  sys %8.3fs  maxrss %8ld KB\n"
+
+void print_times(FILE *out, const char *label, double wall, const struct rusage *ru)
+{
+    fprintf(out, TIMES_FMT, label, wall, tv_secs(&ru->ru_utime), tv_secs(&ru->ru_stime), ru->ru_maxrss);
+}
+
+static const char* job_state_str(const job_t *j, char *buf, size_t n)
+{
+    if (j->state == JOB_RUNNING) return "Running";
+    if (j->state == JOB_STOPPED) return "Stopped";
+    int st = last_stage_status(j);
+    if (WIFSIGNALED(st))
+        snprintf(buf, n, "Killed(%d)", WTERMSIG(st));
+    else
+        snprintf(buf, n, "Done(%d)", WEXITSTATUS(st));
+    return buf;
+}
+
+void print_jobs(int verbose)
+{
+    int shown = 0;
+    char sbuf[32];
+    for (int i = 0; i < job_cap; i++) {
+        job_t *j = job_slots[i];
+        if (!j || j->foreground) continue;
+        shown++;
+        const char *state = job_state_str(j, sbuf, sizeof(sbuf));
+        if (!verbose) {
+            out_printf("[%d] %d  %-10s %s", j->id, (int)j->pgid, state, j->cmd);
+            if (j->place) out_printf("  (%s)", j->place);
+            out_printf("\n");
+        } else {
+            out_printf("[%d] %-10s %s", j->id, state, j->cmd);
+            if (j->place) out_printf("  (%s)", j->place);
+            out_printf("\n");
+            for (int k = 0; k < j->nprocs; k++) {
+                proc_t *p = &j->procs[k];
+                char label[32];
+                snprintf(label, sizeof(label), "  %d", (int)p->pid);
+                if (p->done)
+                    out_printf(TIMES_FMT, label, p->wall, tv_secs(&p->ru.ru_utime),
+                               tv_secs(&p->ru.ru_stime), p->ru.ru_maxrss);
+                else {
+                    // where it may run right now (stages can be pinned apart)
+                    cpu_set_t set;
+                    char cpus[256] = "?";
+                    if (sched_getaffinity(p->pid, sizeof(set), &set) == 0)
+                        format_cpus(&set, cpus, sizeof(cpus));
+                    out_printf("%-10s real %8.3fs  %-9s  cpus %s\n", label, elapsed_since(&j->start),
+                               p->stopped ? "(stopped)" : "(running)", cpus);
+                }
+            }
+            if (j->state == JOB_DONE && j->nprocs > 1) {
+                struct rusage total;
+                job_rusage(j, &total);
+                out_printf(TIMES_FMT, "  total", j->wall, tv_secs(&total.ru_utime),
+                           tv_secs(&total.ru_stime), total.ru_maxrss);
+            }
+        }
+        if (j->state == JOB_DONE) j->notified = 1;
+    }
+    if (shown == 0)
+        out_printf("(no background jobs)\n");
+    // finished jobs are reported once
+    for (int i = 0; i < job_cap; i++)
+        if (job_slots[i] && job_slots[i]->state == JOB_DONE && job_slots[i]->notified && !job_slots[i]->foreground)
+            job_remove(job_slots[i]);
+}
+
+/* ------------ Child exit events ------------ */
+// SIGCHLD is blocked in the shell and delivered through a signalfd, so the
+// interactive loop can sleep in poll() on the terminal and this fd together
+// and reap children the moment they exit. Foreground waits reap their own
+// stages with wait4() and route everything else here, so no status is lost.
+static int sigchld_fd = -1;
+
+#define MAX_DONE_KEPT 256
+
+int child_events_init(void)
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    if (sigprocmask(SIG_BLOCK, &set, NULL) < 0) { perror("sigprocmask"); return -1; }
+    sigchld_fd = signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (sigchld_fd < 0) perror("signalfd");
+    return sigchld_fd;
+}
+
+int child_event_fd(void)
+{
+    return sigchld_fd;
+}
+
+void reap_background(void)
+{
+    // Drain queued SIGCHLD notifications; several exits may share one
+    if (sigchld_fd >= 0) {
+        struct signalfd_siginfo si[16];
+        while (read(sigchld_fd, si, sizeof(si)) > 0)
+            ;
+    }
+
+    int status;
+    pid_t pid;
+    struct rusage ru;
+    // Reap all finished children without blocking
+    while ((pid = wait4(-1, &status, WNOHANG | (job_control ? WUNTRACED : 0), &ru)) > 0)
+        job_reaped(pid, status, &ru);
+
+    // Scripts never see notices: keep finished jobs for 'jobs'/'wait' until
+    // too many have piled up, then drop them
+    if (!shell_interactive && job_count > MAX_DONE_KEPT) {
+        for (int i = 0; i < job_cap; i++)
+            if (job_slots[i] && job_slots[i]->state == JOB_DONE && !job_slots[i]->foreground)
+                job_remove(job_slots[i]);
+    }
+}
+
+static int needs_notice(const job_t *j)
+{
+    return j && !j->foreground && !j->notified && j->state != JOB_RUNNING;
+}
+
+int jobs_have_notices(void)
+{
+    for (int i = 0; i < job_cap; i++)
+        if (needs_notice(job_slots[i])) return 1;
+    return 0;
+}
+
+// Print "[n] Done  cmd" once for every job that finished or stopped since
+// the last notice; finished jobs are then dropped. Returns notices printed.
+int notify_done_jobs(void)
+{
+    int printed = 0;
+    char sbuf[32];
+    for (int i = 0; i < job_cap; i++) {
+        job_t *j = job_slots[i];
+        if (!needs_notice(j)) continue;
+        printf("[%d] %d  %-10s %s\n", j->id, (int)j->pgid, job_state_str(j, sbuf, sizeof(sbuf)), j->cmd);
+        j->notified = 1;
+        printed++;
+        if (j->state == JOB_DONE) job_remove(j);
+    }
+    if (printed) fflush(stdout);
+    return printed;
+}
+
+/* ------------ fg / bg / wait ------------ */
+static job_t* job_arg(const char *name, const char *spec)
+{
+    job_t *j = job_by_spec(spec);
+    if (!j) fprintf(stderr, "myshell: %s: %s: no such job\n", name, spec ? spec : "current");
+    return j;
+}
+
+static void job_continue(job_t *j)
+{
+    for (int i = 0; i < j->nprocs; i++) j->procs[i].stopped = 0;
+    j->state = JOB_RUNNING;
+    if (j->pgid > 0) kill(-j->pgid, SIGCONT);
+    else
+        for (int i = 0; i < j->nprocs; i++)
+            if (!j->procs[i].done) kill(j->procs[i].pid, SIGCONT);
+}
+
+int builtin_fg(char **args)
+{
+    job_t *j = job_arg("fg", args[1]);
+    if (!j) return 1;
+    out_printf("%s\n", j->cmd);
+    out_flush();
+    j->foreground = 1;
+    if (j->state == JOB_STOPPED) job_continue(j);
+    int rc = j->state == JOB_DONE ? job_exit_code(j) : job_wait(j, 1);
+    if (j->state == JOB_DONE) job_remove(j);
+    return rc;
+}
+
+int builtin_bg(char **args)
+{
+    job_t *j = job_arg("bg", args[1]);
+    if (!j) return 1;
+    if (j->state == JOB_STOPPED) job_continue(j);
+    out_printf("[%d] %s &\n", j->id, j->cmd);
+    return 0;
+}
+
+// wait [id...]: with no argument wait for every background job
+int builtin_wait(char **args)
+{
+    int rc = 0;
+    if (args[1] == NULL) {
+        for (int i = 0; i < job_cap; i++) {
+            job_t *j = job_slots[i];
+            if (!j || j->foreground) continue;
+            if (j->state == JOB_RUNNING) job_wait(j, 0);
+            rc = job_exit_code(j);
+            if (j->state == JOB_DONE) job_remove(j);
+        }
+        return rc;
+    }
+    for (int a = 1; args[a]; a++) {
+        job_t *j = job_arg("wait", args[a]);
+        if (!j) { rc = 127; continue; }
+        if (j->state == JOB_RUNNING) job_wait(j, 0);
+        rc = j->state == JOB_STOPPED ? 128 + SIGTSTP : job_exit_code(j);
+        if (j->state == JOB_DONE) job_remove(j);
+    }
+    return rc;
+}
@@ -1,83 +1,346 @@
 #include "shell.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-int main() {
-    // Set custom completion function
-    rl_attempted_completion_function = myshell_completion;
+/* ------------ Non-interactive input (script file, -c, piped stdin) ------------ */
+// Scripts never touch readline: no prompt, no terminal setup, no history
+// file. Regular files are mmap()ed and parsed in place; pipes are drained
+// through a large buffer.
 
-    while (1) {
-        // Reap any finished background jobs before showing prompt
-        reap_background();
-        char *cmdline = readline(PROMPT);
-        if (!cmdline) break; // EOF (Ctrl-D)
-        if (cmdline[0] == '\0') { free(cmdline); continue; }
-
-        add_history(cmdline);
-
-        // History expansion (!n)
-        if (cmdline[0] == '!') {
-            char *p = cmdline + 1;
-            while (*p == ' ' || *p == '\t') p++;
-            char *endptr = NULL; errno = 0;
-            long n = strtol(p, &endptr, 10);
-            if (p == endptr || errno != 0 || n <= 0 || n > history_length) {
-                fprintf(stderr, "myshell: !%ld: event not found\n", n);
-                free(cmdline); continue;
-            }
-            HIST_ENTRY *he = history_get((int)n);
-            if (!he) { fprintf(stderr, "myshell: !%ld: event not found\n", n); free(cmdline); continue; }
-            char *expanded = strdup(he->line);
-            if (!expanded) { perror("strdup"); free(cmdline); continue; }
-            printf("%s\n", expanded);
-            free(cmdline); cmdline = expanded;
+#define SCRIPT_BUFSZ (1 << 16)
+
+// '!n' still works at the start of a script line. Its history is the last
+// SCRIPT_HIST command lines (not continuations or here-document bodies),
+// numbered from 1. A line of an in-memory script is kept as a pointer into
+// the buffer, which outlives the run; a line of a stream is copied into
+// its ring slot, whose buffer is reused. Memory stays bounded however long
+// the input runs.
+#define SCRIPT_HIST 1000
+
+typedef struct {
+    const char *s;     // the line (not NUL-terminated)
+    size_t      len;
+    char       *copy;  // stream lines: the slot's own buffer
+    size_t      cap;
+} shist_t;
+
+static shist_t shist[SCRIPT_HIST];
+static long    shist_total = 0;  // command lines recorded so far
+
+// The n of a '!n' line (blanks allowed around n), 0 if the line is
+// something else, such as '! cmd'
+static long hist_event(const char *line, size_t len)
+{
+    if (len == 0 || line[0] != '!') return 0;
+    size_t k = 1;
+    while (k < len && (line[k] == ' ' || line[k] == '\t')) k++;
+    long n = 0;
+    size_t d = k;
+    for (; d < len && line[d] >= '0' && line[d] <= '9'; d++) {
+        if (n > (LONG_MAX - 9) / 10) return 0;
+        n = n * 10 + (line[d] - '0');
+    }
+    if (d == k) return 0;
+    while (d < len && (line[d] == ' ' || line[d] == '\t')) d++;
+    return d == len ? n : 0;
+}
+
+// Record a command line, or expand '!n' and record that; returns the line
+// to run, valid until the next call. stable: line stays valid for the
+// whole run (an in-memory script), so it is not copied.
+static const char* script_line(const char *line, size_t *len, int more, int stable)
+{
+    if (more) return line;
+    long n = hist_event(line, *len);
+    if (n) {
+        if (n > shist_total || n <= shist_total - SCRIPT_HIST) {
+            fprintf(stderr, "myshell: !%ld: event not found\n", n);
+            *len = 0; // the line is dropped, as at the prompt
+            return line;
+        }
+        const shist_t *e = &shist[(n - 1) % SCRIPT_HIST];
+        line = e->s;
+        *len = e->len;
+        printf("%.*s\n", (int)*len, line);
+        fflush(stdout);
+    }
+    if (*len == 0) return line;
+    shist_t *e = &shist[shist_total % SCRIPT_HIST];
+    if (!stable && line != e->copy) {
+        if (*len > e->cap) {
+            char *nb = (char*)realloc(e->copy, *len);
+            if (!nb) { perror("realloc"); return line; }
+            e->copy = nb;
+            e->cap = *len;
         }
+        memmove(e->copy, line, *len);
+        line = e->copy;
+    }
+    e->s = line;
+    e->len = *len;
+    shist_total++;
+    return line;
+}
 
-        // Split on semicolons for command chaining
-        char *work = strdup(cmdline);
-        if (!work) { perror("strdup"); free(cmdline); continue; }
-        char *saveptr = NULL;
-        char *segment = strtok_r(work, ";", &saveptr);
-        while (segment) {
-            // Trim leading/trailing whitespace
-            while (*segment == ' ' || *segment == '\t') segment++;
-            char *end = segment + strlen(segment);
-            while (end > segment && (end[-1] == ' ' || end[-1] == '\t')) { end--; }
-            *end = '\0';
-            if (*segment == '\0') { segment = strtok_r(NULL, ";", &saveptr); continue; }
-
-            // Check for background '&' at end
-            int background = 0;
-            char *bend = segment + strlen(segment);
-            // skip trailing spaces before '&'
-            char *scan = bend - 1;
-            while (scan >= segment && (*scan == ' ' || *scan == '\t')) scan--;
-            if (scan >= segment && *scan == '&') {
-                background = 1;
-                // remove '&' and any whitespace before next parse
-                *scan = '\0';
-                // trim again trailing spaces
-                char *e2 = scan; while (e2 > segment && (e2[-1] == ' ' || e2[-1] == '\t')) { e2--; } *e2 = '\0';
-            }
+// An in-memory script. If sync_fd >= 0 it is the shell's stdin and the
+// script itself: its offset is moved past each line as the line is read
+// and read back before the next one, so commands that read stdin consume
+// input exactly as with a line-at-a-time shell.
+typedef struct {
+    line_src_t  src;
+    const char *buf;
+    size_t      len, pos;
+    int         sync_fd;
+} buf_src_t;
+
+static const char* buf_read(line_src_t *src, int more, size_t *len)
+{
+    buf_src_t *b = (buf_src_t*)src;
+    if (b->sync_fd >= 0) {
+        off_t cur = lseek(b->sync_fd, 0, SEEK_CUR);
+        if (cur >= 0 && (size_t)cur > b->pos) b->pos = (size_t)cur < b->len ? (size_t)cur : b->len;
+    }
+    if (b->pos >= b->len) return NULL;
+    const char *line = b->buf + b->pos;
+    const char *nl = (const char*)memchr(line, '\n', b->len - b->pos);
+    *len = nl ? (size_t)(nl - line) : b->len - b->pos;
+    b->pos = nl ? (size_t)(nl - b->buf) + 1 : b->len;
+    b->src.last = b->pos >= b->len;
+    if (b->sync_fd >= 0) lseek(b->sync_fd, (off_t)b->pos, SEEK_SET);
+    return script_line(line, len, more, 1);
+}
+
+static void run_buffer(const char *buf, size_t len, size_t pos, int sync_fd)
+{
+    buf_src_t b = { { buf_read, 0 }, buf, len, pos, sync_fd };
+    run_source(&b.src);
+}
+
+// Buffered reader for pipes and other unmappable input: lines are handed
+// out of buf[start..have) and the buffer is refilled once none is complete
+typedef struct {
+    line_src_t src;
+    int        fd;
+    char      *buf;
+    size_t     cap, start, have;
+    int        eof;
+} stream_src_t;
+
+static const char* stream_read(line_src_t *src, int more, size_t *len)
+{
+    stream_src_t *st = (stream_src_t*)src;
+    for (;;) {
+        char *line = st->buf + st->start;
+        char *nl = (char*)memchr(line, '\n', st->have - st->start);
+        if (nl || (st->eof && st->start < st->have)) {
+            // the last line may lack its '\n'
+            *len = nl ? (size_t)(nl - line) : st->have - st->start;
+            st->start = nl ? (size_t)(nl - st->buf) + 1 : st->have;
+            return script_line(line, len, more, 0);
+        }
+        if (st->eof) return NULL;
+        // keep the partial line, then read more
+        memmove(st->buf, line, st->have - st->start);
+        st->have -= st->start;
+        st->start = 0;
+        if (st->have == st->cap) {
+            char *nb = (char*)realloc(st->buf, st->cap * 2); // a single very long line
+            if (!nb) { perror("realloc"); st->eof = 1; continue; }
+            st->buf = nb;
+            st->cap *= 2;
+        }
+        ssize_t n = read(st->fd, st->buf + st->have, st->cap - st->have);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("read");
+            st->eof = 1;
+        } else if (n == 0)
+            st->eof = 1;
+        else
+            st->have += (size_t)n;
+    }
+}
+
+static void run_stream(int fd)
+{
+    stream_src_t st = { { stream_read, 0 }, fd, (char*)malloc(SCRIPT_BUFSZ), SCRIPT_BUFSZ, 0, 0, 0 };
+    if (!st.buf) { perror("malloc"); return; }
+    run_source(&st.src);
+    free(st.buf);
+}
+
+static int run_fd(int fd, int is_stdin)
+{
+    struct stat sb;
+    if (fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode)) {
+        if (sb.st_size == 0) return 0;
+        off_t base = is_stdin ? lseek(fd, 0, SEEK_CUR) : 0;
+        if (base < 0) base = 0;
+        void *map = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, (size_t)sb.st_size, MADV_SEQUENTIAL);
+            if ((size_t)base < (size_t)sb.st_size)
+                run_buffer((const char*)map, (size_t)sb.st_size, (size_t)base, is_stdin ? fd : -1);
+            munmap(map, (size_t)sb.st_size);
+            return 0;
+        }
+    }
+    run_stream(fd);
+    return 0;
+}
+
+/* ------------ Interactive input (readline) ------------ */
+// readline's callback interface lets the shell own the wait: poll() sleeps
+// on the terminal and the SIGCHLD signalfd together, so background jobs are
+// reaped and announced as soon as they exit, even while the prompt sits idle.
+static char *rl_result;
+static int   rl_have_line;
+
+static void on_rl_line(char *line)
+{
+    rl_result = line;
+    rl_have_line = 1;
+    rl_callback_handler_remove();
+}
+
+static char* read_command(const char *prompt)
+{
+    // announce jobs that finished while the last command ran
+    reap_background();
+    notify_done_jobs();
 
-            if (*segment != '\0') {
-                char *cmd_copy = strdup(segment); // for job display
-                if (!cmd_copy) { perror("strdup"); }
-                char **arglist = tokenize(segment);
-                if (arglist) {
-                    // Handle variable assignments (built-in, no fork) and expand $VARS
-                    process_assignments(arglist);
-                    expand_variables(arglist);
-                    execute(arglist, background, cmd_copy ? cmd_copy : segment);
-                    for (int i = 0; arglist[i] != NULL; i++) free(arglist[i]);
-                    free(arglist);
+    rl_have_line = 0;
+    rl_result = NULL;
+    rl_callback_handler_install(prompt, on_rl_line);
+    int cfd = child_event_fd();
+    while (!rl_have_line) {
+        struct pollfd fds[2] = {
+            { .fd = STDIN_FILENO, .events = POLLIN },
+            { .fd = cfd,          .events = POLLIN },
+        };
+        if (poll(fds, cfd >= 0 ? 2 : 1, -1) < 0) {
+            if (errno == EINTR) {
+                if (shell_interrupted) {
+                    // ^C at the prompt discards the line being edited
+                    shell_interrupted = 0;
+                    rl_replace_line("", 0);
+                    rl_crlf();
+                    rl_on_new_line();
+                    rl_redisplay();
                 }
-                if (cmd_copy) free(cmd_copy);
+                continue;
             }
-
-            segment = strtok_r(NULL, ";", &saveptr);
+            perror("poll");
+            rl_callback_handler_remove();
+            return NULL;
+        }
+        if (cfd >= 0 && (fds[1].revents & POLLIN)) {
+            reap_background();
+        }
+        if (jobs_have_notices()) {
+            // print above the prompt, then redraw it with the pending input
+            rl_clear_visible_line();
+            notify_done_jobs();
+            rl_on_new_line();
+            rl_forced_update_display();
         }
-        free(work);
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR))
+            rl_callback_read_char();
+    }
+    return rl_result;
+}
+
+// Interactive lines: '!n' is expanded at the start of a command, and every
+// line is recorded in the history as entered
+typedef struct {
+    line_src_t src;
+    char      *line;  // readline's buffer for the current line
+} tty_src_t;
+
+static const char* tty_read(line_src_t *src, int more, size_t *len)
+{
+    tty_src_t *t = (tty_src_t*)src;
+    free(t->line);
+    t->line = NULL;
+    char *cmdline;
+    for (;;) {
+        cmdline = read_command(more ? PROMPT2 : PROMPT);
+        if (!cmdline) return NULL; // EOF (Ctrl-D)
+        long n = more ? 0 : hist_event(cmdline, strlen(cmdline));
+        if (!n) break;
+
+        // History expansion (!n); the expanded line is what gets recorded
+        char *expanded = hist_get(n);
         free(cmdline);
+        if (!expanded) {
+            fprintf(stderr, "myshell: !%ld: event not found\n", n);
+            continue;
+        }
+        printf("%s\n", expanded);
+        cmdline = expanded;
+        break;
     }
+    if (cmdline[0]) hist_add(cmdline);
+    t->line = cmdline;
+    *len = strlen(cmdline);
+    return cmdline;
+}
+
+static void run_interactive(void)
+{
+    // Set custom completion function
+    rl_attempted_completion_function = myshell_completion;
+
+    tty_src_t t = { { tty_read, 0 }, NULL };
+    run_source(&t.src);
+    free(t.line);
     printf("\nShell exited.\n");
-    return 0;
-}
\ No newline at end of file
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: myshell [-i] [-c command | script]\n");
+    exit(2);
+}
+
+int main(int argc, char *argv[]) {
+    const char *command = NULL;
+    int force_interactive = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "+c:i")) != -1) {
+        switch (opt) {
+        case 'c': command = optarg; break;
+        case 'i': force_interactive = 1; break;
+        default:  usage();
+        }
+    }
+
+    import_environ();
+    child_events_init();
+
+    if (command) {
+        run_buffer(command, strlen(command), 0, -1);
+    } else if (optind < argc) {
+        int fd = open(argv[optind], O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            fprintf(stderr, "myshell: %s: %s\n", argv[optind], strerror(errno));
+            return 127;
+        }
+        run_fd(fd, 0);
+        close(fd);
+    } else if (force_interactive || isatty(STDIN_FILENO)) {
+        shell_interactive = 1;
+        job_control_init();
+        hist_init();
+        cmd_index_start();
+        run_interactive();
+    } else {
+        run_fd(STDIN_FILENO, 1);
+    }
+    // a script exits with the status of its last command, the same whether
+    // that command was exec()ed in place or waited for
+    return last_status;
+}
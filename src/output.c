@@ -0,0 +1,117 @@
+#include "shell.h"
+#include <stdarg.h>
+
+/* ------------ Builtin output buffer ------------ */
+// Builtins format straight into one large buffer that goes out with a
+// single write(2) when the builtin returns (or when it fills up), instead
+// of a stdio flush per line when stdout is a terminal or a pipe. 'history'
+// or 'set' on a big table thus costs a handful of system calls.
+
+#define OUT_BUFSZ (1 << 16)
+
+static char   out_buf[OUT_BUFSZ];
+static size_t out_len = 0;
+
+// While a command substitution captures a builtin, output collects here
+// instead of going to stdout
+static int    capturing = 0;
+static char  *cap_buf = NULL;
+static size_t cap_len = 0, cap_cap = 0;
+
+// Write all n bytes unless the descriptor fails (e.g. the reader went away)
+int write_all(int fd, const void *buf, size_t n)
+{
+    const char *p = (const char*)buf;
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+    return 0;
+}
+
+static void out_emit(const char *s, size_t n)
+{
+    if (!capturing) {
+        write_all(STDOUT_FILENO, s, n);
+        return;
+    }
+    if (cap_len + n > cap_cap) {
+        size_t ncap = cap_cap ? cap_cap : 256;
+        while (ncap < cap_len + n) ncap *= 2;
+        char *nb = (char*)realloc(cap_buf, ncap);
+        if (!nb) { perror("realloc"); return; }
+        cap_buf = nb;
+        cap_cap = ncap;
+    }
+    memcpy(cap_buf + cap_len, s, n);
+    cap_len += n;
+}
+
+void out_flush(void)
+{
+    if (out_len == 0) return;
+    out_emit(out_buf, out_len);
+    out_len = 0;
+}
+
+// Collect builtin output in memory until out_capture_end(), which returns
+// it malloc'd (not NUL-terminated; NULL if nothing was written)
+void out_capture_begin(void)
+{
+    out_flush();
+    capturing = 1;
+    cap_buf = NULL;
+    cap_len = cap_cap = 0;
+}
+
+char* out_capture_end(size_t *len)
+{
+    out_flush();
+    capturing = 0;
+    *len = cap_len;
+    return cap_buf;
+}
+
+void out_write(const char *s, size_t n)
+{
+    if (out_len + n > OUT_BUFSZ) {
+        out_flush();
+        if (n > OUT_BUFSZ) { out_emit(s, n); return; }
+    }
+    memcpy(out_buf + out_len, s, n);
+    out_len += n;
+}
+
+void out_printf(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(out_buf + out_len, OUT_BUFSZ - out_len, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if ((size_t)n < OUT_BUFSZ - out_len) {
+        out_len += (size_t)n;
+        return;
+    }
+    // did not fit: flush and format again, from the heap if still too big
+    out_flush();
+    if ((size_t)n < OUT_BUFSZ) {
+        va_start(ap, fmt);
+        vsnprintf(out_buf, OUT_BUFSZ, fmt, ap);
+        va_end(ap);
+        out_len = (size_t)n;
+        return;
+    }
+    char *tmp = (char*)malloc((size_t)n + 1);
+    if (!tmp) { perror("malloc"); return; }
+    va_start(ap, fmt);
+    vsnprintf(tmp, (size_t)n + 1, fmt, ap);
+    va_end(ap);
+    out_emit(tmp, (size_t)n);
+    free(tmp);
+}
@@ -0,0 +1,283 @@
+#include "shell.h"
+#include <fcntl.h>
+#include <poll.h>
+
+/* ------------ parallel: bounded-concurrency job pool ------------ */
+// parallel [-j N] cmd... [{}] ::: arg...    (or one arg per line on stdin)
+//
+// Arguments form a work queue; one command runs per argument, at most N at
+// once, and a new one starts as soon as a slot frees up. The template is
+// plain words: a '|' in it is an argument (for a pipeline per argument,
+// run 'sh -c "... | ..." sh {}'). Each job's stdout goes to its own
+// pipe and is buffered, then written out whole and in argument order, so
+// outputs never interleave. Children are started through spawn_pipeline(),
+// i.e. the same posix_spawn path as any other command.
+
+typedef struct {
+    char  *buf;
+    size_t len, cap;
+    int    fd;        // read end of the job's stdout pipe, -1 once at EOF
+    job_t *job;       // NULL once reaped (or if it never started)
+    int    status;    // exit code
+    int    finished;
+} pjob_t;
+
+static int pjob_append(pjob_t *pj, const char *data, size_t n)
+{
+    if (pj->len + n > pj->cap) {
+        size_t ncap = pj->cap ? pj->cap * 2 : 4096;
+        while (ncap < pj->len + n) ncap *= 2;
+        char *nb = (char*)realloc(pj->buf, ncap);
+        if (!nb) { perror("realloc"); return -1; }
+        pj->buf = nb;
+        pj->cap = ncap;
+    }
+    memcpy(pj->buf + pj->len, data, n);
+    pj->len += n;
+    return 0;
+}
+
+// Substitute {} in every template word (or append the argument if no word
+// mentions it) and hand the result to the spawn path
+static job_t* start_one(char **tmpl, int ntmpl, const char *arg, arena_t *a, int out_fd, int *rc)
+{
+    arena_reset(a);
+    char **argv = (char**)arena_alloc(a, (size_t)(ntmpl + 2) * sizeof(char*));
+    if (!argv) { *rc = 1; return NULL; }
+    int used = 0;
+    size_t alen = strlen(arg);
+    for (int i = 0; i < ntmpl; i++) {
+        const char *t = tmpl[i];
+        const char *hit = strstr(t, "{}");
+        if (!hit) {
+            argv[i] = tmpl[i];
+            continue;
+        }
+        used = 1;
+        arena_begin(a);
+        while (hit) {
+            arena_addn(a, t, (size_t)(hit - t));
+            arena_addn(a, arg, alen);
+            t = hit + 2;
+            hit = strstr(t, "{}");
+        }
+        arena_addn(a, t, strlen(t));
+        argv[i] = arena_finish(a);
+    }
+    int n = ntmpl;
+    if (!used) argv[n++] = (char*)arg;
+    argv[n] = NULL;
+    return spawn_pipeline(argv, arg, -1, out_fd, 0, rc);
+}
+
+// Read one argument per line from stdin
+static char** read_stdin_args(int *count)
+{
+    size_t cap = 1 << 16, len = 0;
+    char *data = (char*)malloc(cap);
+    if (!data) { perror("malloc"); return NULL; }
+    for (;;) {
+        if (len == cap) {
+            char *nd = (char*)realloc(data, cap * 2);
+            if (!nd) { perror("realloc"); free(data); return NULL; }
+            data = nd;
+            cap *= 2;
+        }
+        ssize_t r = read(STDIN_FILENO, data + len, cap - len);
+        if (r < 0) { if (errno == EINTR) continue; perror("read"); break; }
+        if (r == 0) break;
+        len += (size_t)r;
+    }
+    int n = 0;
+    for (size_t i = 0; i < len; i++) if (data[i] == '\n') n++;
+    // the strings live in the same block, right after the pointer array
+    char **args = (char**)malloc((size_t)(n + 2) * sizeof(char*) + len + 1);
+    if (!args) { perror("malloc"); free(data); return NULL; }
+    char *strs = (char*)(args + n + 2);
+    memcpy(strs, data, len);
+    strs[len] = '\0';
+    free(data);
+    int k = 0;
+    char *p = strs;
+    while (*p) {
+        char *nl = strchr(p, '\n');
+        if (nl) *nl = '\0';
+        if (*p) args[k++] = p;
+        if (!nl) break;
+        p = nl + 1;
+    }
+    args[k] = NULL;
+    *count = k;
+    return args;
+}
+
+int builtin_parallel(char **args)
+{
+    long slots = sysconf(_SC_NPROCESSORS_ONLN);
+    if (slots < 1) slots = 1;
+    int i = 1;
+    while (args[i] && args[i][0] == '-') {
+        if (strcmp(args[i], "-j") == 0 && args[i+1]) {
+            slots = strtol(args[i+1], NULL, 10);
+            i += 2;
+        } else if (strncmp(args[i], "-j", 2) == 0 && args[i][2]) {
+            slots = strtol(args[i] + 2, NULL, 10);
+            i++;
+        } else {
+            fprintf(stderr, "myshell: parallel: usage: parallel [-j N] cmd [{}] [::: args...]\n");
+            return 2;
+        }
+    }
+    if (slots < 1) slots = 1;
+
+    char **tmpl = &args[i];
+    int ntmpl = 0;
+    while (tmpl[ntmpl] && strcmp(tmpl[ntmpl], ":::") != 0) ntmpl++;
+    if (ntmpl == 0) {
+        fprintf(stderr, "myshell: parallel: missing command\n");
+        return 2;
+    }
+
+    char **items;
+    int nitems = 0;
+    char **from_stdin = NULL;
+    if (tmpl[ntmpl]) {
+        items = &tmpl[ntmpl + 1];
+        while (items[nitems]) nitems++;
+    } else {
+        from_stdin = read_stdin_args(&nitems);
+        if (!from_stdin) return 1;
+        items = from_stdin;
+    }
+    // the template stops at ":::" (restored before returning)
+    char *sep = tmpl[ntmpl];
+    tmpl[ntmpl] = NULL;
+
+    pjob_t *pj = (pjob_t*)calloc((size_t)nitems + 1, sizeof(pjob_t));
+    struct pollfd *pfds = (struct pollfd*)malloc(((size_t)slots + 1) * sizeof(struct pollfd));
+    int *pidx = (int*)malloc(((size_t)slots + 1) * sizeof(int));
+    if (!pj || !pfds || !pidx) {
+        perror("malloc");
+        free(pj); free(pfds); free(pidx); free(from_stdin);
+        tmpl[ntmpl] = sep;
+        return 1;
+    }
+
+    arena_t scratch = {0};
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int next = 0, running = 0, emitted = 0, failed = 0;
+    int cfd = child_event_fd();
+
+    while (emitted < nitems) {
+        // fill free slots
+        while (running < slots && next < nitems) {
+            pjob_t *p = &pj[next];
+            int fds[2];
+            p->fd = -1;
+            if (shell_interrupted) {
+                // ^C: the running children got SIGINT too; start nothing new
+                p->finished = 1;
+                p->status = 130;
+                next++;
+                continue;
+            }
+            if (pipe2(fds, O_CLOEXEC) < 0) { perror("pipe"); p->finished = 1; p->status = 1; next++; continue; }
+            int rc = 0;
+            p->job = start_one(tmpl, ntmpl, items[next], &scratch, fds[1], &rc);
+            close(fds[1]);
+            if (!p->job) {
+                close(fds[0]);
+                p->finished = 1;
+                p->status = rc ? rc : 127;
+            } else {
+                p->fd = fds[0];
+                running++;
+            }
+            next++;
+        }
+
+        // emit finished jobs in argument order
+        while (emitted < next && pj[emitted].finished) {
+            pjob_t *p = &pj[emitted];
+            if (p->len) out_write(p->buf, p->len);
+            if (p->status) failed++;
+            free(p->buf);
+            p->buf = NULL;
+            emitted++;
+        }
+        out_flush();
+        if (emitted == nitems) break;
+
+        // wait for output or child exits
+        int nf = 0;
+        for (int k = emitted; k < next; k++) {
+            if (pj[k].fd >= 0) {
+                pfds[nf].fd = pj[k].fd;
+                pfds[nf].events = POLLIN;
+                pidx[nf++] = k;
+            }
+        }
+        int have_cfd = 0;
+        if (cfd >= 0) {
+            pfds[nf].fd = cfd;
+            pfds[nf].events = POLLIN;
+            pidx[nf++] = -1;
+            have_cfd = 1;
+        }
+        if (nf > 0 && poll(pfds, (nfds_t)nf, have_cfd ? -1 : 100) < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+        for (int k = 0; k < nf; k++) {
+            if (pidx[k] < 0 || !(pfds[k].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            pjob_t *p = &pj[pidx[k]];
+            char chunk[65536];
+            ssize_t r = read(p->fd, chunk, sizeof(chunk));
+            if (r > 0) {
+                pjob_append(p, chunk, (size_t)r);
+            } else if (r == 0 || errno != EINTR) {
+                close(p->fd);
+                p->fd = -1;
+            }
+        }
+
+        // reap: every exited child is routed to its job by the job table.
+        // A stopped worker (^Z) would hold its slot forever: kill it, and it
+        // is reaped as failed on a later round
+        reap_background();
+        for (int k = emitted; k < next; k++) {
+            pjob_t *p = &pj[k];
+            if (!p->finished && p->job && p->job->state == JOB_STOPPED) {
+                fprintf(stderr, "myshell: parallel: %s: stopped, killed\n", items[k]);
+                for (int s = 0; s < p->job->nprocs; s++)
+                    if (!p->job->procs[s].done) kill(p->job->procs[s].pid, SIGKILL);
+                p->job->state = JOB_RUNNING;
+            }
+            if (p->finished || !p->job || p->job->state != JOB_DONE || p->fd >= 0) continue;
+            p->status = job_exit_code(p->job);
+            job_remove(p->job);
+            p->job = NULL;
+            p->finished = 1;
+            running--;
+        }
+    }
+
+    shell_interrupted = 0;
+    double secs = elapsed_since(&t0);
+    fprintf(stderr, "parallel: %d jobs in %.3fs (%.1f jobs/s, -j %ld), %d failed\n",
+            nitems, secs, secs > 0 ? nitems / secs : 0.0, slots, failed);
+
+    for (int k = 0; k < nitems; k++) {
+        if (pj[k].fd >= 0) close(pj[k].fd);
+        if (pj[k].job) { job_wait(pj[k].job, 0); job_remove(pj[k].job); }
+        free(pj[k].buf);
+    }
+    arena_destroy(&scratch);
+    free(pj);
+    free(pfds);
+    free(pidx);
+    free(from_stdin);
+    tmpl[ntmpl] = sep;
+    return failed > 101 ? 101 : failed;
+}
@@ -0,0 +1,1306 @@
+#include "shell.h"
+#include <fcntl.h>
+#include <stdint.h>
+
+/* ------------ Command trees ------------ */
+// Input is read a line at a time from a line_src_t. Each complete command
+// (one line, or as many lines as an open if/while/for or a trailing && or
+// || needs) is parsed into a tree in parse_arena, run, and released. Loop
+// bodies are therefore lexed once however often they run.
+//
+// Words keep what is needed to expand them again: quotes are removed at
+// parse time, and a word with no $ reference is stored finished, so
+// running it costs nothing. Other words are a list of literal pieces and
+// variable references that expand_word() joins at run time.
+//
+// '<(list)' and '>(list)' are pieces of their own too: each run starts
+// the list in a child connected to a pipe and expands to its /dev/fd path.
+// '$(list)' and '`list`' are kept as text the same way and run each time
+// the word expands, their output taking their place.
+//
+// A here-document body is read once its command line is finished, and
+// becomes a word like any other (unless its delimiter was quoted, with $
+// references expanded), handed to execute() after a '<<' operator.
+
+enum { T_WORD, T_NEWLINE, T_EOF, T_SEMI, T_AMP, T_AND, T_OR, T_PIPE, T_LESS, T_GREAT,
+       T_DLESS, T_DLESSDASH, T_TLESS, T_LESSAND, T_GREATAND };
+
+enum { WP_LIT, WP_VAR, WP_STATUS, WP_PROC_IN, WP_PROC_OUT, WP_CMDSUB, WP_CMDSUB_Q };
+
+typedef struct {
+    const char *s;     // WP_LIT: the text; WP_VAR: the name; WP_PROC_*, WP_CMDSUB*: the list
+    size_t      len;
+    int         kind;
+} wpart_t;
+
+typedef struct {
+    const char *text;  // the word itself if nothing needs expanding, else NULL
+    wpart_t    *parts;
+    int         nparts;
+    int         quoted; // had quotes: kept even if it expands to ""
+    int         glob;   // unquoted '*', '?' or '[': matched against files
+    int         split;  // unquoted $(...): its output splits into fields
+} word_t;
+
+enum { N_CMD, N_AND, N_OR, N_NOT, N_IF, N_WHILE, N_UNTIL, N_FOR };
+
+struct node {
+    int      type;
+    node_t  *next;       // following command of the same list
+    node_t  *cond;       // N_AND/N_OR: left side; N_NOT: operand; N_IF, loops: condition
+    node_t  *body;       // N_AND/N_OR: right side; N_IF: then-part; loops: body
+    node_t  *alt;        // N_IF: elif/else part
+    word_t **words;      // N_CMD: the words; N_FOR: the items
+    int      nwords;
+    const char *name;    // N_FOR: loop variable
+    const char *raw;     // N_CMD: source text, for job listings
+    int      background; // N_CMD followed by '&'
+};
+
+// Operators inside a simple command, and the prefix keywords, are handed
+// to execute() as these words: it knows them by the address of their text
+// (syntax_word()), so a quoted or expanded word that reads the same is an
+// ordinary argument. An unquoted '@CPUS' word follows op_at.
+static word_t op_pipe     = { "|", NULL, 0, 0, 0, 0 };
+static word_t op_less     = { "<", NULL, 0, 0, 0, 0 };
+static word_t op_great    = { ">", NULL, 0, 0, 0, 0 };
+static word_t op_dless    = { "<<", NULL, 0, 0, 0, 0 };
+static word_t op_tless    = { "<<<", NULL, 0, 0, 0, 0 };
+static word_t op_lessand  = { "<&", NULL, 0, 0, 0, 0 };
+static word_t op_greatand = { ">&", NULL, 0, 0, 0, 0 };
+static word_t op_at       = { "@", NULL, 0, 0, 0, 0 };
+static word_t kw_time     = { "time", NULL, 0, 0, 0, 0 };
+static word_t kw_pipesize = { "pipesize", NULL, 0, 0, 0, 0 };
+static word_t kw_affinity = { "affinity", NULL, 0, 0, 0, 0 };
+static word_t kw_nice     = { "nice", NULL, 0, 0, 0, 0 };
+static word_t kw_ulimit   = { "ulimit", NULL, 0, 0, 0, 0 };
+
+static const word_t *syn_words[SYN_COUNT] = {
+    [SYN_PIPE] = &op_pipe, [SYN_LESS] = &op_less, [SYN_GREAT] = &op_great,
+    [SYN_DLESS] = &op_dless, [SYN_TLESS] = &op_tless, [SYN_LESSAND] = &op_lessand,
+    [SYN_GREATAND] = &op_greatand, [SYN_AT] = &op_at, [SYN_TIME] = &kw_time,
+    [SYN_PIPESIZE] = &kw_pipesize, [SYN_AFFINITY] = &kw_affinity, [SYN_NICE] = &kw_nice,
+    [SYN_ULIMIT] = &kw_ulimit,
+};
+
+int syntax_word(const char *arg)
+{
+    for (int i = 1; i < SYN_COUNT; i++)
+        if (arg == syn_words[i]->text) return i;
+    return SYN_NONE;
+}
+
+// The keyword word for an unquoted word spelling one, else w
+static word_t* keyword_word(word_t *w)
+{
+    if (!w->text || w->quoted || w->glob) return w;
+    for (int i = SYN_TIME; i < SYN_COUNT; i++)
+        if (strcmp(w->text, syn_words[i]->text) == 0) return (word_t*)syn_words[i];
+    return w;
+}
+
+#define MAX_HEREDOCS 16   // per line
+
+typedef struct {
+    word_t     *body;    // filled in once the line is finished
+    const char *delim;
+    int         expand;  // delimiter was unquoted
+    int         strip;   // '<<-': leading tabs removed
+} heredoc_t;
+
+typedef struct {
+    line_src_t *src;
+    arena_t    *a;
+    const char *cp, *end;  // rest of the current line
+    int         lines;     // lines read for this command
+    int         tok;       // current token
+    word_t     *word;      // T_WORD
+    const char *tok_start, *tok_end; // source span of the current token
+    int         error;
+    heredoc_t   hd[MAX_HEREDOCS]; // here-documents whose bodies follow this line
+    int         nhd;
+} parser_t;
+
+static arena_t parse_arena;  // the tree of the command being run
+static arena_t exec_arena;   // expanded words of the simple command being run
+
+int last_status = 0;
+
+/* ------------ Lexer ------------ */
+// Scratch space for the pieces of the word being lexed; copied into the
+// arena once the word is finished
+static wpart_t *wparts = NULL;
+static size_t   nwparts = 0, wparts_cap = 0;
+
+static int push_part(int kind, size_t off, size_t len)
+{
+    if (nwparts == wparts_cap) {
+        size_t ncap = wparts_cap ? wparts_cap * 2 : 16;
+        wpart_t *np = (wpart_t*)realloc(wparts, ncap * sizeof(wpart_t));
+        if (!np) { perror("realloc"); return -1; }
+        wparts = np;
+        wparts_cap = ncap;
+    }
+    // offsets into the word being built: it may still move in the arena
+    wparts[nwparts++] = (wpart_t){ (const char*)(uintptr_t)off, len, kind };
+    return 0;
+}
+
+// Record the literal text since lit_start as a piece of its own
+static int close_literal(parser_t *p, size_t *lit_start)
+{
+    size_t len = arena_objlen(p->a);
+    if (len > *lit_start && push_part(WP_LIT, *lit_start, len - *lit_start) < 0) return -1;
+    *lit_start = len;
+    return 0;
+}
+
+static const char* procsub_end(const char *cp, const char *end);
+
+// A command substitution whose list is [start, stop): the text becomes a
+// piece (split into fields when it is not quoted). Returns the position
+// after the closing ')' or '`', if any.
+static const char* lex_cmdsub(parser_t *p, const char *start, const char *stop,
+                              size_t *lit_start, int quoted)
+{
+    if (close_literal(p, lit_start) < 0) return NULL;
+    size_t off = arena_objlen(p->a);
+    arena_addn(p->a, start, (size_t)(stop - start));
+    if (push_part(quoted ? WP_CMDSUB_Q : WP_CMDSUB, off, (size_t)(stop - start)) < 0) return NULL;
+    *lit_start = arena_objlen(p->a);
+    return stop < p->end ? stop + 1 : stop;
+}
+
+// The '`' closing the backquoted command at cp, or end
+static const char* backquote_end(const char *cp, const char *end)
+{
+    const char *q = memchr(cp + 1, '`', (size_t)(end - cp - 1));
+    return q ? q : end;
+}
+
+// A reference at cp ('$NAME', '${NAME}', '$?', '$(list)'): its name goes
+// into the word's buffer and becomes a piece. A '$' that starts no
+// reference is kept literally. Returns the position after it.
+static const char* lex_ref(parser_t *p, const char *cp, size_t *lit_start, int quoted)
+{
+    const char *q = cp + 1;
+    if (q < p->end && *q == '(')
+        return lex_cmdsub(p, cp + 2, procsub_end(cp, p->end), lit_start, quoted);
+    int braced = q < p->end && *q == '{';
+    if (braced) q++;
+    const char *name = q;
+    if (q < p->end && *q == '?') {
+        q++;
+    } else if (q < p->end && is_valid_var_start(*q)) {
+        while (q < p->end && is_valid_var_char(*q)) q++;
+    } else {
+        arena_addc(p->a, '$');
+        return cp + 1;
+    }
+    if (braced && (q == p->end || *q != '}')) {
+        arena_addc(p->a, '$');
+        return cp + 1;
+    }
+    if (close_literal(p, lit_start) < 0) return NULL;
+    if (*name == '?') {
+        if (push_part(WP_STATUS, 0, 0) < 0) return NULL;
+    } else {
+        size_t off = arena_objlen(p->a);
+        arena_addn(p->a, name, (size_t)(q - name));
+        if (push_part(WP_VAR, off, (size_t)(q - name)) < 0) return NULL;
+        *lit_start = arena_objlen(p->a);
+    }
+    return braced ? q + 1 : q;
+}
+
+static int is_word_end(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == ';' || c == '&' ||
+           c == '|' || c == '<' || c == '>';
+}
+
+// '<(' or '>(' at cp
+static int is_procsub(const char *cp, const char *end)
+{
+    return (*cp == '<' || *cp == '>') && cp + 1 < end && cp[1] == '(';
+}
+
+// The ')' closing the process substitution at cp (quotes and nested
+// parentheses skipped), or end if it is not closed on this line
+static const char* procsub_end(const char *cp, const char *end)
+{
+    const char *q = cp + 2;
+    int depth = 1;
+    for (; q < end; q++) {
+        if (*q == '\'' || *q == '"') {
+            char quote = *q;
+            while (++q < end && *q != quote) {}
+            if (q == end) break;
+        } else if (*q == '(') {
+            depth++;
+        } else if (*q == ')' && --depth == 0) {
+            break;
+        }
+    }
+    return q;
+}
+
+// A process substitution at cp: the text up to the matching ')' becomes a
+// piece. An unclosed one runs to the end of the line. Returns the
+// position after it.
+static const char* lex_procsub(parser_t *p, const char *cp, size_t *lit_start)
+{
+    int kind = *cp == '<' ? WP_PROC_IN : WP_PROC_OUT;
+    const char *start = cp + 2, *q = procsub_end(cp, p->end);
+    if (close_literal(p, lit_start) < 0) return NULL;
+    size_t off = arena_objlen(p->a);
+    arena_addn(p->a, start, (size_t)(q - start));
+    if (push_part(kind, off, (size_t)(q - start)) < 0) return NULL;
+    *lit_start = arena_objlen(p->a);
+    return q < p->end ? q + 1 : q;
+}
+
+static int is_glob_char(char c)
+{
+    return c == '*' || c == '?' || c == '[';
+}
+
+// Does the word at cp have an unquoted '*', '?' or '['
+static int word_has_glob(const char *cp, const char *end)
+{
+    while (cp < end && (!is_word_end(*cp) || is_procsub(cp, end))) {
+        if (is_procsub(cp, end) || (*cp == '$' && cp + 1 < end && cp[1] == '(')) {
+            cp = procsub_end(cp, end);
+        } else if (*cp == '`') {
+            cp = backquote_end(cp, end);
+        } else if (*cp == '\'' || *cp == '"') {
+            char quote = *cp;
+            while (++cp < end && *cp != quote) {}
+        } else if (is_glob_char(*cp)) {
+            return 1;
+        }
+        if (cp < end) cp++;
+    }
+    return 0;
+}
+
+// Literal text of a word; in a glob word, '\' marks each character that
+// must match itself (quoted glob characters, and '\' everywhere)
+static void add_literal(parser_t *p, const char *s, size_t n, int glob, int quoted)
+{
+    if (!glob) {
+        arena_addn(p->a, s, n);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (s[i] == '\\' || (quoted && is_glob_char(s[i]))) arena_addc(p->a, '\\');
+        arena_addc(p->a, s[i]);
+    }
+}
+
+// Read one word at p->cp: '...' is literal, "..." and unquoted text expand
+// '$' and '`...`', '<(...)' / '>(...)' are process substitutions. A quote
+// left open runs to the end of the line.
+static word_t* finish_word(parser_t *p, word_t *w, int quoted, size_t lit_start);
+
+static word_t* lex_word(parser_t *p)
+{
+    const char *cp = p->cp, *end = p->end;
+    size_t lit_start = 0;
+    int quoted = 0;
+    int glob = word_has_glob(cp, end);
+    word_t *w = (word_t*)arena_alloc(p->a, sizeof(word_t));
+    if (!w) return NULL;
+    nwparts = 0;
+    arena_begin(p->a);
+    while (cp < end && (!is_word_end(*cp) || is_procsub(cp, end))) {
+        if (is_procsub(cp, end)) {
+            if (!(cp = lex_procsub(p, cp, &lit_start))) return NULL;
+        } else if (*cp == '\'') {
+            const char *start = ++cp;
+            while (cp < end && *cp != '\'') cp++;
+            add_literal(p, start, (size_t)(cp - start), glob, 1);
+            if (cp < end) cp++;
+            quoted = 1;
+        } else if (*cp == '"') {
+            cp++;
+            while (cp < end && *cp != '"') {
+                const char *start = cp;
+                while (cp < end && *cp != '"' && *cp != '$' && *cp != '`') cp++;
+                add_literal(p, start, (size_t)(cp - start), glob, 1);
+                if (cp < end && *cp == '$' && !(cp = lex_ref(p, cp, &lit_start, 1))) return NULL;
+                if (cp < end && *cp == '`' &&
+                    !(cp = lex_cmdsub(p, cp + 1, backquote_end(cp, end), &lit_start, 1))) return NULL;
+            }
+            if (cp < end) cp++;
+            quoted = 1;
+        } else if (*cp == '$') {
+            if (!(cp = lex_ref(p, cp, &lit_start, 0))) return NULL;
+        } else if (*cp == '`') {
+            if (!(cp = lex_cmdsub(p, cp + 1, backquote_end(cp, end), &lit_start, 0))) return NULL;
+        } else {
+            const char *start = cp;
+            while (cp < end && !is_word_end(*cp) && *cp != '\'' && *cp != '"' && *cp != '$' &&
+                   *cp != '`') cp++;
+            add_literal(p, start, (size_t)(cp - start), glob, 0);
+        }
+    }
+    p->cp = cp;
+    if (!finish_word(p, w, quoted, lit_start)) return NULL;
+    w->glob = glob;
+    return w;
+}
+
+// Finish the word being built into w (allocated before the word began)
+static word_t* finish_word(parser_t *p, word_t *w, int quoted, size_t lit_start)
+{
+    int plain = nwparts == 0;
+    if (!plain && close_literal(p, &lit_start) < 0) return NULL;
+    char *buf = arena_finish(p->a);
+    if (!buf) return NULL;
+    w->quoted = quoted;
+    w->glob = 0;
+    w->split = 0;
+    w->nparts = (int)nwparts;
+    w->parts = NULL;
+    w->text = plain ? buf : NULL;
+    if (!plain) {
+        w->parts = (wpart_t*)arena_alloc(p->a, nwparts * sizeof(wpart_t));
+        if (!w->parts) return NULL;
+        for (size_t i = 0; i < nwparts; i++) {
+            w->parts[i] = wparts[i];
+            w->parts[i].s = buf + (uintptr_t)wparts[i].s;
+            if (wparts[i].kind == WP_CMDSUB) w->split = 1;
+        }
+    }
+    return w;
+}
+
+// Drop the '\'s of the first n bytes of s in place; returns the new length
+static size_t strip_escapes(char *s, size_t n)
+{
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (s[i] == '\\' && i + 1 < n) i++;
+        s[k++] = s[i];
+    }
+    return k;
+}
+
+// Take a glob word as written after all (a redirection's file name)
+static void unglob_word(word_t *w)
+{
+    if (!w->glob) return;
+    w->glob = 0;
+    if (w->text) {
+        char *t = (char*)w->text; // in the parse arena
+        t[strip_escapes(t, strlen(t))] = '\0';
+        return;
+    }
+    for (int i = 0; i < w->nparts; i++)
+        if (w->parts[i].kind == WP_LIT)
+            w->parts[i].len = strip_escapes((char*)w->parts[i].s, w->parts[i].len);
+}
+
+// Read the bodies of the here-documents opened on the line just finished,
+// each up to its delimiter line. A missing delimiter ends the body at end
+// of input, with a warning.
+static void read_heredocs(parser_t *p)
+{
+    for (int i = 0; i < p->nhd && !p->error; i++) {
+        heredoc_t *h = &p->hd[i];
+        size_t dlen = strlen(h->delim), lit_start = 0;
+        nwparts = 0;
+        arena_begin(p->a);
+        for (;;) {
+            size_t len;
+            const char *line = p->src->read(p->src, 1, &len);
+            if (!line) {
+                fprintf(stderr, "myshell: warning: here-document delimited by end of file (wanted '%s')\n", h->delim);
+                break;
+            }
+            const char *end = line + len;
+            if (h->strip)
+                while (line < end && *line == '\t') line++;
+            if ((size_t)(end - line) == dlen && memcmp(line, h->delim, dlen) == 0) break;
+            if (!h->expand) {
+                arena_addn(p->a, line, (size_t)(end - line));
+            } else {
+                p->cp = line;
+                p->end = end;
+                for (const char *cp = line; cp < end; ) {
+                    const char *start = cp;
+                    while (cp < end && *cp != '$') cp++;
+                    arena_addn(p->a, start, (size_t)(cp - start));
+                    if (cp < end && !(cp = lex_ref(p, cp, &lit_start, 1))) { p->error = 1; break; }
+                }
+            }
+            arena_addc(p->a, '\n');
+        }
+        if (!finish_word(p, h->body, 1, lit_start)) p->error = 1;
+    }
+    p->nhd = 0;
+    p->cp = p->end = NULL;
+}
+
+// Move to the next token. Past a newline this reads another line (after
+// any here-document bodies), so at the end of a complete command the
+// parser stops without advancing.
+static void advance(parser_t *p)
+{
+    if (p->tok == T_EOF) return;
+    if (p->tok == T_NEWLINE) {
+        if (p->nhd) read_heredocs(p);
+        size_t len;
+        const char *line = p->src->read(p->src, p->lines++ > 0, &len);
+        if (!line) { p->tok = T_EOF; return; }
+        p->cp = line;
+        p->end = line + len;
+    }
+    while (p->cp < p->end && (*p->cp == ' ' || *p->cp == '\t' || *p->cp == '\r')) p->cp++;
+    p->tok_start = p->cp;
+    if (p->cp == p->end || *p->cp == '#') {
+        p->tok = T_NEWLINE;
+        return;
+    }
+    char c = *p->cp;
+    if (is_procsub(p->cp, p->end)) c = '('; // '<(' / '>(' start a word
+    int two = p->cp + 1 < p->end && p->cp[1] == c;
+    char third = two && p->cp + 2 < p->end ? p->cp[2] : '\0';
+    int len = two ? 2 : 1;
+    int dupfd = p->cp + 1 < p->end && p->cp[1] == '&';  // '<&N', '>&N'
+    switch (c) {
+    case ';': p->tok = T_SEMI; break;
+    case '&': p->tok = two ? T_AND : T_AMP; break;
+    case '|': p->tok = two ? T_OR : T_PIPE; break;
+    case '<':
+        p->tok = dupfd ? T_LESSAND : !two ? T_LESS : third == '<' ? T_TLESS : third == '-' ? T_DLESSDASH : T_DLESS;
+        if (dupfd) len = 2;
+        else if (third == '<' || third == '-') len = 3;
+        break;
+    case '>':
+        p->tok = dupfd ? T_GREATAND : T_GREAT;
+        len = dupfd ? 2 : 1;
+        break;
+    default:
+        p->tok = T_WORD;
+        p->word = lex_word(p);
+        if (!p->word) { p->error = 1; p->tok = T_EOF; }
+        p->tok_end = p->cp;
+        return;
+    }
+    if (c == ';') len = 1;
+    p->cp += len;
+    p->tok_end = p->cp;
+}
+
+/* ------------ Parser ------------ */
+static void syntax_error(parser_t *p)
+{
+    if (p->error) return;
+    p->error = 1;
+    if (p->tok == T_EOF)
+        fprintf(stderr, "myshell: syntax error: unexpected end of file\n");
+    else if (p->tok == T_NEWLINE)
+        fprintf(stderr, "myshell: syntax error near unexpected newline\n");
+    else
+        fprintf(stderr, "myshell: syntax error near unexpected token '%.*s'\n",
+                (int)(p->tok_end - p->tok_start), p->tok_start);
+}
+
+// The current token is the reserved word kw (unquoted, in command position)
+static int is_kw(const parser_t *p, const char *kw)
+{
+    return p->tok == T_WORD && p->word->text && !p->word->quoted &&
+           strcmp(p->word->text, kw) == 0;
+}
+
+// Reserved words that close a list
+static int at_list_end(const parser_t *p)
+{
+    return is_kw(p, "then") || is_kw(p, "elif") || is_kw(p, "else") ||
+           is_kw(p, "fi") || is_kw(p, "do") || is_kw(p, "done");
+}
+
+static int expect(parser_t *p, const char *kw)
+{
+    if (!is_kw(p, kw)) { syntax_error(p); return 0; }
+    advance(p);
+    return 1;
+}
+
+static node_t* new_node(parser_t *p, int type)
+{
+    node_t *n = (node_t*)arena_alloc(p->a, sizeof(node_t));
+    if (!n) { p->error = 1; return NULL; }
+    memset(n, 0, sizeof(*n));
+    n->type = type;
+    return n;
+}
+
+// Words of a simple command or a for list, gathered before they are
+// copied into the arena (a simple command never contains another)
+static word_t **wscratch = NULL;
+static size_t   wscratch_cap = 0;
+
+static word_t** copy_words(parser_t *p, size_t n)
+{
+    word_t **v = (word_t**)arena_alloc(p->a, (n ? n : 1) * sizeof(word_t*));
+    if (!v) { p->error = 1; return NULL; }
+    if (n) memcpy(v, wscratch, n * sizeof(word_t*));
+    return v;
+}
+
+static int push_word(parser_t *p, size_t *n, word_t *w)
+{
+    if (*n == wscratch_cap) {
+        size_t ncap = wscratch_cap ? wscratch_cap * 2 : 32;
+        word_t **nv = (word_t**)realloc(wscratch, ncap * sizeof(word_t*));
+        if (!nv) { perror("realloc"); p->error = 1; return -1; }
+        wscratch = nv;
+        wscratch_cap = ncap;
+    }
+    wscratch[(*n)++] = w;
+    return 0;
+}
+
+static node_t* parse_list(parser_t *p, int top);
+
+// '<<WORD', '<<-WORD' or '<<< word' (at the operator): the here-string
+// word follows '<<<' as is; a here-document gets an empty word that is
+// filled in when the line ends. Leaves the parser at the word.
+static int parse_heredoc(parser_t *p, size_t *nw)
+{
+    int op = p->tok;
+    advance(p);
+    if (p->tok != T_WORD || (op != T_TLESS && !p->word->text)) { syntax_error(p); return -1; }
+    if (op == T_TLESS) {
+        unglob_word(p->word);
+        return push_word(p, nw, &op_tless) < 0 || push_word(p, nw, p->word) < 0 ? -1 : 0;
+    }
+    if (p->nhd == MAX_HEREDOCS) {
+        fprintf(stderr, "myshell: too many here-documents on one line\n");
+        p->error = 1;
+        return -1;
+    }
+    heredoc_t *h = &p->hd[p->nhd];
+    h->body = (word_t*)arena_alloc(p->a, sizeof(word_t));
+    if (!h->body) { p->error = 1; return -1; }
+    memset(h->body, 0, sizeof(word_t));
+    h->body->text = "";
+    h->delim = p->word->text;
+    h->expand = !p->word->quoted;
+    h->strip = op == T_DLESSDASH;
+    p->nhd++;
+    return push_word(p, nw, &op_dless) < 0 || push_word(p, nw, h->body) < 0 ? -1 : 0;
+}
+
+// Words and '|', '<', '>', '<&', '>&', '<<', '<<<' up to the end of the command;
+// execute() splits them into pipeline stages when it runs
+static node_t* parse_simple(parser_t *p)
+{
+    node_t *n = new_node(p, N_CMD);
+    if (!n) return NULL;
+    const char *start = p->tok_start, *end = p->tok_end;
+    size_t nw = 0;
+    for (;;) {
+        if (p->tok == T_DLESS || p->tok == T_DLESSDASH || p->tok == T_TLESS) {
+            if (parse_heredoc(p, &nw) < 0) return NULL;
+            end = p->tok_end;
+            advance(p);
+            continue;
+        }
+        word_t *w = p->tok == T_WORD ? p->word : p->tok == T_PIPE ? &op_pipe :
+                    p->tok == T_LESS ? &op_less : p->tok == T_GREAT ? &op_great :
+                    p->tok == T_LESSAND ? &op_lessand : p->tok == T_GREATAND ? &op_greatand : NULL;
+        if (!w) break;
+        // a redirection's file name (or descriptor) is taken as written
+        if (w == p->word && nw && (wscratch[nw-1] == &op_less || wscratch[nw-1] == &op_great ||
+                                   wscratch[nw-1] == &op_lessand || wscratch[nw-1] == &op_greatand)) {
+            unglob_word(w);
+        } else if (w == p->word) {
+            w = keyword_word(w);
+            if (w->text && !w->quoted && !w->glob && w->text[0] == '@' && w->text[1] &&
+                push_word(p, &nw, &op_at) < 0) return NULL;
+        }
+        if (push_word(p, &nw, w) < 0) return NULL;
+        end = p->tok_end;
+        advance(p);
+    }
+    if (!(n->words = copy_words(p, nw))) return NULL;
+    n->nwords = (int)nw;
+    n->raw = arena_strndup(p->a, start, (size_t)(end - start));
+    return n->raw ? n : NULL;
+}
+
+// A list that must not be empty, e.g. between 'then' and 'fi'
+static node_t* parse_block(parser_t *p)
+{
+    node_t *list = parse_list(p, 0);
+    if (!list) syntax_error(p);
+    return p->error ? NULL : list;
+}
+
+// if list then list [elif list then list]... [else list] fi
+// (at 'if' or 'elif'; an elif chain shares the final 'fi')
+static node_t* parse_if(parser_t *p)
+{
+    node_t *n = new_node(p, N_IF);
+    if (!n) return NULL;
+    advance(p);
+    if (!(n->cond = parse_block(p)) || !expect(p, "then") || !(n->body = parse_block(p)))
+        return NULL;
+    if (is_kw(p, "elif"))
+        return (n->alt = parse_if(p)) ? n : NULL;
+    if (is_kw(p, "else")) {
+        advance(p);
+        if (!(n->alt = parse_block(p))) return NULL;
+    }
+    return expect(p, "fi") ? n : NULL;
+}
+
+// while list do list done, until list do list done
+static node_t* parse_while(parser_t *p, int type)
+{
+    node_t *n = new_node(p, type);
+    if (!n) return NULL;
+    advance(p);
+    if (!(n->cond = parse_block(p)) || !expect(p, "do") ||
+        !(n->body = parse_block(p)) || !expect(p, "done"))
+        return NULL;
+    return n;
+}
+
+// for NAME [in word...] ; do list done
+static node_t* parse_for(parser_t *p)
+{
+    node_t *n = new_node(p, N_FOR);
+    if (!n) return NULL;
+    advance(p);
+    const char *name = p->tok == T_WORD && !p->word->quoted ? p->word->text : NULL;
+    if (!name || !is_valid_var_start(*name)) { syntax_error(p); return NULL; }
+    for (const char *c = name; *c; c++)
+        if (!is_valid_var_char(*c)) { syntax_error(p); return NULL; }
+    n->name = name;
+    advance(p);
+    while (p->tok == T_NEWLINE) advance(p);
+    size_t nw = 0;
+    if (is_kw(p, "in")) {
+        advance(p);
+        for (; p->tok == T_WORD; advance(p))
+            if (push_word(p, &nw, p->word) < 0) return NULL;
+        if (p->tok != T_SEMI && p->tok != T_NEWLINE) { syntax_error(p); return NULL; }
+        advance(p);
+    } else if (p->tok == T_SEMI) {
+        advance(p);
+    }
+    if (!(n->words = copy_words(p, nw))) return NULL;
+    n->nwords = (int)nw;
+    while (p->tok == T_NEWLINE) advance(p);
+    if (!expect(p, "do") || !(n->body = parse_block(p)) || !expect(p, "done"))
+        return NULL;
+    return n;
+}
+
+// [!] command, where a command is a simple one (possibly a pipeline with
+// redirections) or an if/while/until/for
+static node_t* parse_command(parser_t *p)
+{
+    if (is_kw(p, "!")) {
+        node_t *n = new_node(p, N_NOT);
+        if (!n) return NULL;
+        advance(p);
+        return (n->cond = parse_command(p)) ? n : NULL;
+    }
+    if (is_kw(p, "if"))    return parse_if(p);
+    if (is_kw(p, "while")) return parse_while(p, N_WHILE);
+    if (is_kw(p, "until")) return parse_while(p, N_UNTIL);
+    if (is_kw(p, "for"))   return parse_for(p);
+    if (at_list_end(p) || (p->tok != T_WORD && p->tok != T_LESS && p->tok != T_GREAT &&
+                           p->tok != T_LESSAND && p->tok != T_GREATAND &&
+                           p->tok != T_DLESS && p->tok != T_DLESSDASH && p->tok != T_TLESS)) {
+        syntax_error(p);
+        return NULL;
+    }
+    return parse_simple(p);
+}
+
+// command [&& command | || command]..., left to right; a newline may
+// follow the operator
+static node_t* parse_and_or(parser_t *p)
+{
+    node_t *left = parse_command(p);
+    while (left && (p->tok == T_AND || p->tok == T_OR)) {
+        node_t *n = new_node(p, p->tok == T_AND ? N_AND : N_OR);
+        if (!n) return NULL;
+        advance(p);
+        while (p->tok == T_NEWLINE) advance(p);
+        n->cond = left;
+        if (!(n->body = parse_command(p))) return NULL;
+        left = n;
+    }
+    return left;
+}
+
+// Commands separated by ';', '&' or (inside a compound command) newlines.
+// The top-level list of a complete command ends at the end of its line.
+static node_t* parse_list(parser_t *p, int top)
+{
+    node_t *head = NULL, **tail = &head;
+    for (;;) {
+        if (!top)
+            while (p->tok == T_NEWLINE) advance(p);
+        if (p->tok == T_EOF || p->tok == T_NEWLINE || at_list_end(p))
+            break;
+        node_t *n = parse_and_or(p);
+        if (!n) return NULL;
+        *tail = n;
+        tail = &n->next;
+        if (p->tok == T_AMP) {
+            // background jobs are pipelines; there is no subshell to run
+            // a compound command in
+            if (n->type != N_CMD) { syntax_error(p); return NULL; }
+            n->background = 1;
+            advance(p);
+        } else if (p->tok == T_SEMI) {
+            advance(p);
+        } else if (p->tok != T_NEWLINE && p->tok != T_EOF && !at_list_end(p)) {
+            syntax_error(p);
+            return NULL;
+        }
+    }
+    return head;
+}
+
+/* ------------ Running trees ------------ */
+static int   procsub_start(const char *text, size_t len, int out);
+static char* cmdsub_run(const char *text, size_t len, size_t *outlen);
+
+static int cmdsub_status = -1; // of the last $(...) the command expanded
+
+// A value is not a pattern: in a glob word, quote it like the lexer did
+static void add_value(arena_t *a, const char *val, size_t n, int glob)
+{
+    if (!glob) {
+        arena_addn(a, val, n);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (val[i] == '\\' || is_glob_char(val[i])) arena_addc(a, '\\');
+        arena_addc(a, val[i]);
+    }
+}
+
+// Output of a command substitution without its trailing newlines. NUL
+// bytes are dropped; unquoted, each run of blanks becomes a NUL, which
+// expand_command() splits the word at.
+static void add_output(arena_t *a, const char *out, size_t n, int split, int glob)
+{
+    while (n > 0 && out[n-1] == '\n') n--;
+    for (size_t i = 0; i < n; ) {
+        size_t j = i;
+        while (j < n && out[j] != '\0' && !(split && (out[j] == ' ' || out[j] == '\t' || out[j] == '\n'))) j++;
+        add_value(a, out + i, j - i, glob);
+        if (j < n && out[j] != '\0') {
+            arena_addc(a, '\0');
+            while (j + 1 < n && (out[j+1] == ' ' || out[j+1] == '\t' || out[j+1] == '\n')) j++;
+        }
+        i = j + 1;
+    }
+}
+
+// The word's text in arena a; *len counts the NULs of split output too
+static const char* expand_word(const word_t *w, arena_t *a, size_t *len)
+{
+    if (w->text) {
+        *len = strlen(w->text);
+        return w->text;
+    }
+    arena_begin(a);
+    for (int i = 0; i < w->nparts; i++) {
+        const wpart_t *wp = &w->parts[i];
+        if (wp->kind == WP_LIT) {
+            arena_addn(a, wp->s, wp->len);
+        } else if (wp->kind == WP_VAR) {
+            const char *val = get_varn(wp->s, wp->len);
+            add_value(a, val, strlen(val), w->glob);
+        } else if (wp->kind == WP_CMDSUB || wp->kind == WP_CMDSUB_Q) {
+            size_t n;
+            char *out = cmdsub_run(wp->s, wp->len, &n);
+            add_output(a, out ? out : "", n, wp->kind == WP_CMDSUB, w->glob);
+            free(out);
+        } else if (wp->kind == WP_PROC_IN || wp->kind == WP_PROC_OUT) {
+            int fd = procsub_start(wp->s, wp->len, wp->kind == WP_PROC_OUT);
+            if (fd < 0) { arena_finish(a); return NULL; }
+            char path[32];
+            int len = snprintf(path, sizeof(path), "/dev/fd/%d", fd);
+            arena_addn(a, path, (size_t)len);
+        } else {
+            char num[16];
+            int len = snprintf(num, sizeof(num), "%d", last_status);
+            arena_addn(a, num, (size_t)len);
+        }
+    }
+    *len = arena_objlen(a);
+    return arena_finish(a);
+}
+
+// Append one field to argv (as the paths it matches, in a glob word),
+// keeping room for the rest words still to come; argv moves to a larger
+// block when it has to. NULL on failure.
+static char** add_field(char **argv, size_t *cap, size_t *k, size_t rest,
+                        const char *s, int glob, arena_t *a)
+{
+    size_t nm = 0;
+    char **m = glob && glob_pattern(s) ? glob_expand(s, a, &nm) : NULL;
+    size_t need = *k + (nm ? nm : 1) + rest;
+    if (need > *cap) {
+        size_t ncap = *cap;
+        while (ncap < need) ncap *= 2;
+        char **nv = (char**)arena_alloc(a, ncap * sizeof(char*));
+        if (!nv) { free(m); return NULL; }
+        memcpy(nv, argv, *k * sizeof(char*));
+        argv = nv;
+        *cap = ncap;
+    }
+    if (nm) {
+        memcpy(argv + *k, m, nm * sizeof(char*));
+        *k += nm;
+        free(m);
+        return argv;
+    }
+    char *f = glob ? glob_unescape(s, a) : (char*)s;
+    if (!f) return NULL;
+    argv[(*k)++] = f;
+    return argv;
+}
+
+// The argv of a simple command (or the items of a for loop) in arena a.
+// Words that expand to nothing are dropped unless they were quoted; the
+// output of an unquoted $(...) splits into fields at blanks, empty fields
+// dropped; a glob word (or field) becomes the sorted paths it matches, or
+// stays as written if none do. The argv has no size limit.
+char** expand_command(const node_t *n, arena_t *a)
+{
+    size_t cap = (size_t)n->nwords + 1, k = 0;
+    char **argv = (char**)arena_alloc(a, cap * sizeof(char*));
+    if (!argv) return NULL;
+    for (int i = 0; i < n->nwords; i++) {
+        const word_t *w = n->words[i];
+        size_t len, rest = (size_t)(n->nwords - i); // later words and the NULL
+        const char *s = expand_word(w, a, &len);
+        if (!s) return NULL;
+        if (!w->split || !memchr(s, '\0', len)) {
+            if ((*s || w->quoted || w->glob) &&
+                !(argv = add_field(argv, &cap, &k, rest, s, w->glob, a))) return NULL;
+            continue;
+        }
+        for (const char *f = s, *end = s + len; f < end; f += strlen(f) + 1)
+            if (*f && !(argv = add_field(argv, &cap, &k, rest, f, w->glob, a))) return NULL;
+    }
+    argv[k] = NULL;
+    return argv;
+}
+
+// ^C ends a loop: the shell saw it itself, or (interactive, where the
+// foreground job has the terminal) the command just run died of it
+static int loop_interrupted(int rc)
+{
+    if (shell_interrupted) {
+        shell_interrupted = 0;
+        return 1;
+    }
+    return shell_interactive && rc == 128 + SIGINT;
+}
+
+static int run_node(const node_t *n, int tail);
+
+// tail: nothing runs after this list, so its last command may exec()
+static int run_list(const node_t *n, int tail)
+{
+    int rc = 0;
+    for (; n; n = n->next)
+        rc = run_node(n, tail && !n->next);
+    return rc;
+}
+
+static int run_simple(const node_t *n, int tail)
+{
+    int rc = 1;
+    cmdsub_status = -1;
+    char **argv = expand_command(n, &exec_arena);
+    if (argv) {
+        process_assignments(argv);
+        exec_tail = tail;
+        rc = execute(argv, n->background, n->raw);
+        exec_tail = 0;
+        restore_assignments();
+        // 'X=$(cmd)' (or a lone '$(cmd)' that printed nothing) has its status
+        if (!argv[0] && cmdsub_status >= 0) rc = cmdsub_status;
+    }
+    procsub_reap(); // what execute() did not hand to a job
+    arena_reset(&exec_arena);
+    return rc;
+}
+
+// A for loop's items, expanded once when the loop starts, in one malloc'd
+// block: the body reuses exec_arena for its own commands
+static char** for_items(const node_t *n)
+{
+    char **argv = expand_command(n, &exec_arena);
+    char **items = NULL;
+    if (argv) {
+        size_t cnt = 0, bytes = 0;
+        for (; argv[cnt]; cnt++) bytes += strlen(argv[cnt]) + 1;
+        items = (char**)malloc((cnt + 1) * sizeof(char*) + bytes);
+        if (items) {
+            char *s = (char*)(items + cnt + 1);
+            for (size_t i = 0; i < cnt; i++) {
+                size_t len = strlen(argv[i]) + 1;
+                items[i] = memcpy(s, argv[i], len);
+                s += len;
+            }
+            items[cnt] = NULL;
+        } else
+            perror("malloc");
+    }
+    arena_reset(&exec_arena);
+    return items;
+}
+
+static int run_node(const node_t *n, int tail)
+{
+    int rc = 0;
+    switch (n->type) {
+    case N_CMD:
+        rc = run_simple(n, tail);
+        break;
+    case N_AND:
+    case N_OR:
+        rc = run_node(n->cond, 0);
+        if ((rc == 0) == (n->type == N_AND))
+            rc = run_node(n->body, tail);
+        break;
+    case N_NOT:
+        rc = run_node(n->cond, 0) == 0;
+        break;
+    case N_IF:
+        if (run_list(n->cond, 0) == 0)
+            rc = run_list(n->body, tail);
+        else
+            rc = run_list(n->alt, tail); // an elif is a nested N_IF
+        break;
+    case N_WHILE:
+    case N_UNTIL:
+        for (;;) {
+            int c = run_list(n->cond, 0);
+            if ((c == 0) != (n->type == N_WHILE) || loop_interrupted(c)) break;
+            rc = run_list(n->body, 0);
+            if (loop_interrupted(rc)) break;
+        }
+        break;
+    case N_FOR: {
+        char **items = for_items(n);
+        if (!items) { rc = 1; break; }
+        for (char **it = items; *it; it++) {
+            set_var(n->name, *it);
+            rc = run_list(n->body, 0);
+            if (loop_interrupted(rc)) break;
+        }
+        free(items);
+        break;
+    }
+    }
+    last_status = rc;
+    return rc;
+}
+
+// Parse and run complete commands until the source runs dry. The last
+// command of the input runs in tail position (see exec_tail).
+void run_source(line_src_t *src)
+{
+    parser_t p = { .src = src, .a = &parse_arena };
+    for (;;) {
+        p.tok = T_NEWLINE;
+        p.lines = 0;
+        p.error = 0;
+        p.nhd = 0;
+        advance(&p);
+        if (p.tok == T_EOF && !p.error) break;
+        // from the first token: reading the first line may wait on the user
+        uint64_t t0 = opt_xtrace ? trace_now() : 0;
+        node_t *list = parse_list(&p, 1);
+        if (!p.error && p.tok != T_NEWLINE && p.tok != T_EOF)
+            syntax_error(&p); // e.g. a stray 'fi'
+        if (!p.error && p.nhd)
+            read_heredocs(&p); // the bodies of the last line
+        if (opt_xtrace)
+            trace_event('X', "parse", 0, t0, trace_now() - t0, p.error ? 2 : -1,
+                        list && list->type == N_CMD ? list->raw : NULL);
+        if (p.error) {
+            last_status = 2;
+        } else if (list) {
+            reap_background();
+            run_list(list, src->last);
+        }
+        glob_cache_clear();
+        arena_reset(&parse_arena);
+        if (p.tok == T_EOF) break;
+    }
+}
+
+typedef struct {
+    pid_t pid;
+    int   fd;
+} procsub_t;
+
+// process substitutions started for the command being expanded
+static procsub_t *procsubs = NULL;
+static size_t     nprocsubs = 0, procsubs_cap = 0;
+
+// One line from a string (benchmarks, and the list of a substitution)
+typedef struct {
+    line_src_t  src;
+    const char *s;
+    size_t      len;
+    int         done;
+} str_src_t;
+
+static const char* str_read(line_src_t *src, int more, size_t *len)
+{
+    str_src_t *ss = (str_src_t*)src;
+    (void)more;
+    if (ss->done) return NULL;
+    ss->done = 1;
+    *len = ss->len;
+    return ss->s;
+}
+
+static node_t* parse_text(const char *s, size_t len, arena_t *a)
+{
+    str_src_t ss = { { str_read, 1 }, s, len, 0 };
+    parser_t p = { .src = &ss.src, .a = a, .tok = T_NEWLINE };
+    advance(&p);
+    node_t *list = parse_list(&p, 1);
+    if (!p.error && p.tok != T_NEWLINE && p.tok != T_EOF)
+        syntax_error(&p);
+    return p.error ? NULL : list;
+}
+
+node_t* parse_line(const char *line, arena_t *a)
+{
+    return parse_text(line, strlen(line), a);
+}
+
+// In a forked copy of the shell (its stdin or stdout already moved onto a
+// pipe): run list text[0..len) and exit with its status
+static void run_forked(const char *text, size_t len)
+{
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTSTP, SIG_DFL);
+    signal(SIGTTIN, SIG_DFL);
+    signal(SIGTTOU, SIG_DFL);
+    job_control = 0;
+    shell_interactive = 0;
+    for (size_t i = 0; i < nprocsubs; i++) close(procsubs[i].fd);
+    // the parent's arenas are mid-command: start over with empty ones
+    memset(&parse_arena, 0, sizeof(parse_arena));
+    memset(&exec_arena, 0, sizeof(exec_arena));
+    str_src_t ss = { { str_read, 1 }, text, len, 0 };
+    run_source(&ss.src);
+    out_flush();
+    fflush(stdout);
+    _exit(last_status);
+}
+
+/* ------------ Process substitution ------------ */
+// '<(list)' runs list with its stdout on a pipe, '>(list)' with its stdin
+// on one; the shell keeps the other end open (without CLOEXEC) at the
+// descriptor named by the /dev/fd path, so the command inherits it. The
+// list runs in a forked copy of the shell, which execs a lone command in
+// place. Until execute() hands them to the command's job, the children
+// wait here; the shell closes its ends once the command is launched, so
+// they see EOF or EPIPE when the command is done with them.
+
+// Start list text[0..len) on a new pipe: the descriptor the shell keeps,
+// or -1 after reporting
+static int procsub_start(const char *text, size_t len, int out)
+{
+    if (nprocsubs == procsubs_cap) {
+        size_t ncap = procsubs_cap ? procsubs_cap * 2 : 4;
+        procsub_t *np = (procsub_t*)realloc(procsubs, ncap * sizeof(procsub_t));
+        if (!np) { perror("realloc"); return -1; }
+        procsubs = np;
+        procsubs_cap = ncap;
+    }
+    int pfd[2];
+    if (pipe2(pfd, O_CLOEXEC) < 0) { perror("pipe"); return -1; }
+    int keep = out ? pfd[1] : pfd[0], theirs = out ? pfd[0] : pfd[1];
+    fflush(stdout);
+    uint64_t t0 = opt_xtrace ? trace_now() : 0;
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork failed");
+        close(pfd[0]);
+        close(pfd[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        if (dup2(theirs, out ? STDIN_FILENO : STDOUT_FILENO) < 0) { perror("dup2"); _exit(1); }
+        run_forked(text, len);
+    }
+    if (opt_xtrace) {
+        trace_event('X', "fork", 0, t0, trace_now() - t0, -1, "process substitution");
+        trace_event('B', "process", pid, t0, 0, -1, out ? ">(...)" : "<(...)");
+    }
+    close(theirs);
+    // the command inherits this end
+    fcntl(keep, F_SETFD, 0);
+    procsubs[nprocsubs++] = (procsub_t){ pid, keep };
+    return keep;
+}
+
+// Launched: the job j waits for the children too; the shell's ends close
+void procsub_adopt(job_t *j)
+{
+    for (size_t i = 0; i < nprocsubs; i++) {
+        job_add_aux(j, procsubs[i].pid);
+        close(procsubs[i].fd);
+    }
+    nprocsubs = 0;
+}
+
+// The command ran in the shell (or not at all): close the ends and wait
+// for the children as a hidden job of their own
+void procsub_reap(void)
+{
+    if (nprocsubs == 0) return;
+    job_t *j = job_create("process substitution", 1);
+    if (!j) {
+        for (size_t i = 0; i < nprocsubs; i++) close(procsubs[i].fd);
+        nprocsubs = 0;
+        return;
+    }
+    procsub_adopt(j);
+    job_wait(j, 0);
+    job_remove(j);
+}
+
+/* ------------ Command substitution ------------ */
+// '$(list)' runs list in a forked copy of the shell with its stdout on a
+// pipe (a lone command execs in place) and reads the output into a
+// growable buffer until EOF. A lone builtin that only prints, such as pwd
+// or 'echo $X', runs in the shell instead with its output captured: no
+// fork at all. The list is parsed again each time it runs.
+
+// Builtins with no effect on the shell but their output
+static int pure_builtin(const char *name)
+{
+    static const char *names[] = { "pwd", "echo", "printf", "test", "[", "true", "false", NULL };
+    if (!is_builtin(name)) return 0;
+    for (int i = 0; names[i]; i++)
+        if (strcmp(names[i], name) == 0) return 1;
+    return 0;
+}
+
+// A lone simple command whose first word names a pure builtin as written
+// (expanding it first could run nested substitutions twice)
+static int cmdsub_in_shell(const node_t *n)
+{
+    if (!n || n->type != N_CMD || n->next || n->background || n->nwords == 0) return 0;
+    const word_t *w0 = n->words[0];
+    if (!w0->text || w0->quoted || !pure_builtin(w0->text)) return 0;
+    for (int i = 0; i < n->nwords; i++) {
+        const word_t *w = n->words[i];
+        int syn = w->text ? syntax_word(w->text) : SYN_NONE;
+        if (syn != SYN_NONE && syn < SYN_TIME) return 0; // an operator
+        for (int j = 0; j < w->nparts; j++)
+            if (w->parts[j].kind == WP_PROC_IN || w->parts[j].kind == WP_PROC_OUT) return 0;
+    }
+    return 1;
+}
+
+// Run list text[0..len) for its output: malloc'd, *outlen bytes (NULL if
+// there was none). Sets cmdsub_status.
+static char* cmdsub_run(const char *text, size_t len, size_t *outlen)
+{
+    *outlen = 0;
+    uint64_t t0 = opt_xtrace ? trace_now() : 0;
+    // own arenas: the caller's word is still growing in exec_arena
+    arena_t tree = {0}, words = {0};
+    node_t *n = parse_text(text, len, &tree);
+    if (!n) {
+        arena_destroy(&tree);
+        cmdsub_status = 2;
+        return NULL;
+    }
+    if (cmdsub_in_shell(n)) {
+        char **argv = expand_command(n, &words);
+        char *out = NULL;
+        cmdsub_status = 1;
+        if (argv && argv[0]) {
+            out_capture_begin();
+            cmdsub_status = run_builtin(argv);
+            out = out_capture_end(outlen);
+        }
+        if (opt_xtrace && t0)
+            trace_event('X', "cmdsub", 0, t0, trace_now() - t0, cmdsub_status, argv ? argv[0] : NULL);
+        arena_destroy(&words);
+        arena_destroy(&tree);
+        return out;
+    }
+    arena_destroy(&tree);
+
+    int pfd[2];
+    if (pipe2(pfd, O_CLOEXEC) < 0) {
+        perror("pipe");
+        cmdsub_status = 1;
+        return NULL;
+    }
+    out_flush();
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork failed");
+        close(pfd[0]);
+        close(pfd[1]);
+        cmdsub_status = 1;
+        return NULL;
+    }
+    if (pid == 0) {
+        if (dup2(pfd[1], STDOUT_FILENO) < 0) { perror("dup2"); _exit(1); }
+        run_forked(text, len);
+    }
+    if (opt_xtrace) {
+        trace_event('X', "fork", 0, t0, trace_now() - t0, -1, "command substitution");
+        trace_event('B', "process", pid, t0, 0, -1, "$(...)");
+    }
+    close(pfd[1]);
+    char *buf = NULL;
+    size_t n_read = 0, cap = 0;
+    for (;;) {
+        if (n_read == cap) {
+            size_t ncap = cap ? cap * 2 : 4096;
+            char *nb = (char*)realloc(buf, ncap);
+            if (!nb) { perror("realloc"); break; }
+            buf = nb;
+            cap = ncap;
+        }
+        ssize_t r = read(pfd[0], buf + n_read, cap - n_read);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) break;
+        n_read += (size_t)r;
+    }
+    close(pfd[0]);
+    *outlen = n_read;
+
+    job_t *j = job_create("command substitution", 1);
+    if (j && job_add_proc(j, pid) == 0) {
+        cmdsub_status = job_wait(j, 0);
+        if (j->state != JOB_STOPPED) job_remove(j);
+    } else {
+        job_remove(j);
+        cmdsub_status = 1;
+    }
+    return buf;
+}
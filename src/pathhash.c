@@ -0,0 +1,127 @@
+#include "shell.h"
+#include <sys/stat.h>
+
+/* ------------ Resolved command cache (hash builtin) ------------ */
+// Open-addressing table mapping command names to absolute paths. Failed
+// searches are cached too (path == NULL) so a missing command costs one
+// PATH walk, not one per invocation. Cleared whenever PATH or the working
+// directory changes, since relative PATH entries depend on the cwd.
+
+typedef struct {
+    char *name;      // NULL = empty slot
+    char *path;      // NULL = cached "not found"
+    unsigned long hits;
+} cmd_ent_t;
+
+static cmd_ent_t *ptab = NULL;
+static size_t     ptab_cap = 0;   // power of two
+static size_t     ptab_used = 0;
+static unsigned long ptab_hits = 0;
+static unsigned long ptab_misses = 0;
+
+static cmd_ent_t* slot_for(const char *name)
+{
+    size_t mask = ptab_cap - 1;
+    size_t i = str_hash(name) & mask;
+    while (ptab[i].name && strcmp(ptab[i].name, name) != 0)
+        i = (i + 1) & mask;
+    return &ptab[i];
+}
+
+static int grow_table(void)
+{
+    size_t ncap = ptab_cap ? ptab_cap * 2 : 64;
+    cmd_ent_t *old = ptab;
+    size_t ocap = ptab_cap;
+    ptab = (cmd_ent_t*)calloc(ncap, sizeof(cmd_ent_t));
+    if (!ptab) { perror("calloc"); ptab = old; return -1; }
+    ptab_cap = ncap;
+    for (size_t i = 0; i < ocap; i++)
+        if (old[i].name) *slot_for(old[i].name) = old[i];
+    free(old);
+    return 0;
+}
+
+static char* search_path(const char *name)
+{
+    const char *path = getenv("PATH");
+    if (!path) path = "/usr/local/bin:/usr/bin:/bin";
+    size_t nlen = strlen(name);
+    const char *dir = path;
+    for (;;) {
+        const char *colon = strchr(dir, ':');
+        size_t dlen = colon ? (size_t)(colon - dir) : strlen(dir);
+        char *cand = (char*)malloc(dlen + nlen + 3);
+        if (!cand) { perror("malloc"); return NULL; }
+        if (dlen == 0) {
+            cand[0] = '.'; dlen = 1; // empty entry means cwd
+        } else {
+            memcpy(cand, dir, dlen);
+        }
+        cand[dlen] = '/';
+        memcpy(cand + dlen + 1, name, nlen + 1);
+        struct stat sb;
+        if (stat(cand, &sb) == 0 && S_ISREG(sb.st_mode) && access(cand, X_OK) == 0)
+            return cand;
+        free(cand);
+        if (!colon) break;
+        dir = colon + 1;
+    }
+    return NULL;
+}
+
+const char* path_lookup(const char *name)
+{
+    if (!name || !*name) return NULL;
+    if (strchr(name, '/')) return name; // explicit paths are never cached
+
+    if (ptab_cap) {
+        cmd_ent_t *e = slot_for(name);
+        if (e->name) {
+            e->hits++;
+            ptab_hits++;
+            return e->path;
+        }
+    }
+
+    ptab_misses++;
+    char *resolved = search_path(name);
+    if ((ptab_used + 1) * 2 > ptab_cap && grow_table() < 0) {
+        free(resolved);
+        return NULL;
+    }
+    cmd_ent_t *e = slot_for(name);
+    e->name = strdup(name);
+    if (!e->name) { perror("strdup"); free(resolved); return NULL; }
+    e->path = resolved;
+    e->hits = 0;
+    ptab_used++;
+    return resolved;
+}
+
+void path_cache_clear(void)
+{
+    for (size_t i = 0; i < ptab_cap; i++) {
+        free(ptab[i].name);
+        free(ptab[i].path);
+    }
+    free(ptab);
+    ptab = NULL;
+    ptab_cap = 0;
+    ptab_used = 0;
+}
+
+void path_cache_print(void)
+{
+    size_t shown = 0;
+    for (size_t i = 0; i < ptab_cap; i++) {
+        if (!ptab[i].name) continue;
+        if (shown++ == 0) out_printf("hits\tcommand\n");
+        if (ptab[i].path)
+            out_printf("%4lu\t%s\n", ptab[i].hits, ptab[i].path);
+        else
+            out_printf("%4lu\t%s (not found)\n", ptab[i].hits, ptab[i].name);
+    }
+    if (shown == 0) out_printf("hash: hash table empty\n");
+    out_printf("hash: %lu hits, %lu misses\n", ptab_hits, ptab_misses);
+}
@@ -0,0 +1,331 @@
+#include "shell.h"
+
+/* ------------ CPU placement and resource limits ------------ */
+// 'affinity CPUS cmd', 'nice [-n N] cmd' and 'ulimit -X N cmd' are prefixes
+// like 'time': they apply to every stage of the pipeline after them, and a
+// stage can be pinned on its own with a leading '@CPUS' word
+// ('@0-3 producer | @4-7 consumer'). Placed stages are started with fork
+// so the child can call sched_setaffinity/setpriority/setrlimit on itself
+// before exec; nothing changes in the shell. Without a command, 'affinity'
+// and 'ulimit' act on the shell itself (and so on every later job), and
+// 'affinity CPUS %n' re-pins a running job.
+
+static const struct {
+    char        opt;
+    int         res;
+    rlim_t      unit;   // bytes per unit shown and accepted
+    const char *desc;
+} limit_tab[] = {
+    { 'c', RLIMIT_CORE,    1024, "core file size (KiB)" },
+    { 'd', RLIMIT_DATA,    1024, "data segment size (KiB)" },
+    { 'f', RLIMIT_FSIZE,   1024, "file size (KiB)" },
+    { 'l', RLIMIT_MEMLOCK, 1024, "locked memory (KiB)" },
+    { 'm', RLIMIT_RSS,     1024, "resident set size (KiB)" },
+    { 'n', RLIMIT_NOFILE,  1,    "open files" },
+    { 's', RLIMIT_STACK,   1024, "stack size (KiB)" },
+    { 't', RLIMIT_CPU,     1,    "cpu time (seconds)" },
+    { 'u', RLIMIT_NPROC,   1,    "user processes" },
+    { 'v', RLIMIT_AS,      1024, "virtual memory (KiB)" },
+};
+#define NLIMITS (sizeof(limit_tab) / sizeof(limit_tab[0]))
+
+// "0-3,8,10-11"; -1 if malformed or beyond CPU_SETSIZE
+int parse_cpus(const char *s, cpu_set_t *set)
+{
+    CPU_ZERO(set);
+    if (!*s) return -1;
+    while (*s) {
+        char *end;
+        long lo = strtol(s, &end, 10), hi = lo;
+        if (end == s || lo < 0) return -1;
+        if (*end == '-') {
+            s = end + 1;
+            hi = strtol(s, &end, 10);
+            if (end == s || hi < lo) return -1;
+        }
+        if (hi >= CPU_SETSIZE) return -1;
+        for (long c = lo; c <= hi; c++) CPU_SET((int)c, set);
+        if (*end == ',') end++;
+        else if (*end) return -1;
+        s = end;
+    }
+    return 0;
+}
+
+// The inverse of parse_cpus(), ranges collapsed
+void format_cpus(const cpu_set_t *set, char *buf, size_t len)
+{
+    size_t used = 0;
+    buf[0] = '\0';
+    for (int c = 0; c < CPU_SETSIZE && used < len; c++) {
+        if (!CPU_ISSET(c, set)) continue;
+        int e = c;
+        while (e + 1 < CPU_SETSIZE && CPU_ISSET(e + 1, set)) e++;
+        int n = e > c ? snprintf(buf + used, len - used, "%s%d-%d", used ? "," : "", c, e)
+                      : snprintf(buf + used, len - used, "%s%d", used ? "," : "", c);
+        used += (size_t)n;
+        c = e;
+    }
+}
+
+static int limit_index(char opt)
+{
+    for (size_t i = 0; i < NLIMITS; i++)
+        if (limit_tab[i].opt == opt) return (int)i;
+    return -1;
+}
+
+// "N" (in the resource's units) or "unlimited"
+static int parse_limit(const char *s, size_t idx, rlim_t *out)
+{
+    if (strcmp(s, "unlimited") == 0) { *out = RLIM_INFINITY; return 0; }
+    char *end;
+    errno = 0;
+    unsigned long long v = strtoull(s, &end, 10);
+    if (end == s || *end || errno || *s == '-') return -1;
+    *out = (rlim_t)v * limit_tab[idx].unit;
+    return 0;
+}
+
+// ulimit options: [-S|-H] [-X N]... Fills pl (when given) and returns
+// the words used; *queries counts -X without a value. -1 on bad usage.
+static int parse_ulimit(char **argv, placement_t *pl, int *queries)
+{
+    int which = RL_SOFT | RL_HARD, i = 1;
+    *queries = 0;
+    for (; argv[i] && argv[i][0] == '-' && argv[i][1]; i++) {
+        for (const char *o = argv[i] + 1; *o; o++) {
+            if (*o == 'S') { which = RL_SOFT; continue; }
+            if (*o == 'H') { which = RL_HARD; continue; }
+            if (*o == 'a') { (*queries)++; continue; }
+            int idx = limit_index(*o);
+            if (idx < 0) {
+                fprintf(stderr, "myshell: ulimit: -%c: invalid option\n", *o);
+                return -1;
+            }
+            rlim_t v;
+            if (o[1] || !argv[i+1] || parse_limit(argv[i+1], (size_t)idx, &v) < 0) {
+                (*queries)++;
+                continue;
+            }
+            if (pl->nlimits == PLACE_MAX_LIMITS) {
+                fprintf(stderr, "myshell: ulimit: too many limits\n");
+                return -1;
+            }
+            pl->limits[pl->nlimits].idx = idx;
+            pl->limits[pl->nlimits].which = which;
+            pl->limits[pl->nlimits].val = v;
+            pl->nlimits++;
+            i++;
+            break;
+        }
+    }
+    return i;
+}
+
+int placement_prefix(char **argv, placement_t *pl)
+{
+    if (strcmp(argv[0], "affinity") == 0) {
+        // 'affinity' and 'affinity CPUS [%n]' are the builtin
+        if (!argv[1] || !argv[2] || (argv[2][0] == '%' && !argv[3])) return 0;
+        if (parse_cpus(argv[1], &pl->cpus) < 0) {
+            fprintf(stderr, "myshell: affinity: %s: invalid CPU list\n", argv[1]);
+            return -1;
+        }
+        pl->has_cpus = 1;
+        return 2;
+    }
+    if (strcmp(argv[0], "nice") == 0) {
+        // nice(1) syntax: nice [-n N | -N] cmd, default increment 10
+        int used = 1, inc = 10;
+        const char *n = NULL;
+        if (argv[1] && strcmp(argv[1], "-n") == 0) {
+            if (!argv[2]) {
+                fprintf(stderr, "myshell: nice: -n: option requires an argument\n");
+                return -1;
+            }
+            n = argv[2];
+            used = 3;
+        }
+        else if (argv[1] && argv[1][0] == '-' && argv[1][1]) { n = argv[1] + 1; used = 2; }
+        if (n) {
+            char *end;
+            inc = (int)strtol(n, &end, 10);
+            if (end == n || *end) {
+                fprintf(stderr, "myshell: nice: %s: invalid adjustment\n", n);
+                return -1;
+            }
+        }
+        if (!argv[used]) return 0; // no command: /usr/bin/nice prints the niceness
+        pl->nice += inc;
+        return used;
+    }
+    if (strcmp(argv[0], "ulimit") == 0) {
+        placement_t tmp = *pl;
+        int queries;
+        int used = parse_ulimit(argv, &tmp, &queries);
+        if (used < 0) return -1;
+        if (!argv[used]) return 0; // no command: the builtin
+        if (queries || tmp.nlimits == pl->nlimits) {
+            fprintf(stderr, "myshell: ulimit: usage: ulimit [-S|-H] -X N... cmd\n");
+            return -1;
+        }
+        *pl = tmp;
+        return used;
+    }
+    return 0;
+}
+
+int placement_active(const placement_t *pl)
+{
+    return pl->has_cpus || pl->nice || pl->nlimits;
+}
+
+static int apply_limit(int idx, int which, rlim_t val)
+{
+    struct rlimit rl;
+    int res = limit_tab[idx].res;
+    if (getrlimit(res, &rl) < 0) return -1;
+    if (which & RL_SOFT) rl.rlim_cur = val;
+    if (which & RL_HARD) rl.rlim_max = val;
+    // lowering only the hard limit drags the soft one along
+    if (!(which & RL_SOFT) && rl.rlim_cur > rl.rlim_max) rl.rlim_cur = rl.rlim_max;
+    return setrlimit(res, &rl);
+}
+
+// Called in the child between fork and exec (or by the shell just before
+// exec()ing a command in place of itself)
+int apply_placement(const placement_t *pl)
+{
+    if (pl->has_cpus && sched_setaffinity(0, sizeof(cpu_set_t), &pl->cpus) < 0) {
+        perror("myshell: affinity");
+        return -1;
+    }
+    if (pl->nice) {
+        errno = 0;
+        int prio = getpriority(PRIO_PROCESS, 0);
+        if ((prio == -1 && errno) || setpriority(PRIO_PROCESS, 0, prio + pl->nice) < 0)
+            perror("myshell: nice"); // like nice(1): run anyway
+    }
+    for (int i = 0; i < pl->nlimits; i++)
+        if (apply_limit(pl->limits[i].idx, pl->limits[i].which, pl->limits[i].val) < 0) {
+            fprintf(stderr, "myshell: ulimit -%c: %s\n", limit_tab[pl->limits[i].idx].opt, strerror(errno));
+            return -1;
+        }
+    return 0;
+}
+
+// "cpus 0-3, nice 10, ulimit -n 64" for 'jobs'; NULL if nothing is set
+char* placement_describe(const placement_t *pl)
+{
+    if (!placement_active(pl)) return NULL;
+    char buf[512], cpus[256];
+    size_t used = 0;
+    if (pl->has_cpus) {
+        format_cpus(&pl->cpus, cpus, sizeof(cpus));
+        used += (size_t)snprintf(buf + used, sizeof(buf) - used, "cpus %s", cpus);
+    }
+    if (pl->nice && used < sizeof(buf))
+        used += (size_t)snprintf(buf + used, sizeof(buf) - used, "%snice %d", used ? ", " : "", pl->nice);
+    for (int i = 0; i < pl->nlimits && used < sizeof(buf); i++) {
+        rlim_t v = pl->limits[i].val;
+        char val[32];
+        if (v == RLIM_INFINITY) snprintf(val, sizeof(val), "unlimited");
+        else snprintf(val, sizeof(val), "%llu", (unsigned long long)(v / limit_tab[pl->limits[i].idx].unit));
+        used += (size_t)snprintf(buf + used, sizeof(buf) - used, "%s-%c %s",
+                                 i ? " " : used ? ", ulimit " : "ulimit ",
+                                 limit_tab[pl->limits[i].idx].opt, val);
+    }
+    return strdup(buf);
+}
+
+/* ------------ affinity / ulimit builtins ------------ */
+// affinity               show the shell's CPUs
+// affinity CPUS          pin the shell (and every job started later)
+// affinity CPUS %n       re-pin every process of a running job
+int builtin_affinity(char **args)
+{
+    cpu_set_t set;
+    char buf[256];
+    if (!args[1]) {
+        if (sched_getaffinity(0, sizeof(set), &set) < 0) { perror("myshell: affinity"); return 1; }
+        format_cpus(&set, buf, sizeof(buf));
+        out_printf("%s\n", buf);
+        return 0;
+    }
+    if (parse_cpus(args[1], &set) < 0) {
+        fprintf(stderr, "myshell: affinity: %s: invalid CPU list\n", args[1]);
+        return 2;
+    }
+    if (!args[2]) {
+        if (sched_setaffinity(0, sizeof(set), &set) < 0) { perror("myshell: affinity"); return 1; }
+        return 0;
+    }
+    job_t *j = job_by_spec(args[2]);
+    if (!j) {
+        fprintf(stderr, "myshell: affinity: %s: no such job\n", args[2]);
+        return 1;
+    }
+    int rc = 0;
+    for (int k = 0; k < j->nprocs; k++)
+        if (!j->procs[k].done && sched_setaffinity(j->procs[k].pid, sizeof(set), &set) < 0) {
+            fprintf(stderr, "myshell: affinity: %d: %s\n", (int)j->procs[k].pid, strerror(errno));
+            rc = 1;
+        }
+    format_cpus(&set, buf, sizeof(buf));
+    free(j->place);
+    j->place = (char*)malloc(strlen(buf) + 6);
+    if (j->place) sprintf(j->place, "cpus %s", buf);
+    return rc;
+}
+
+static void print_limit(size_t idx, int hard, int with_desc)
+{
+    struct rlimit rl;
+    if (getrlimit(limit_tab[idx].res, &rl) < 0) { perror("myshell: ulimit"); return; }
+    rlim_t v = hard ? rl.rlim_max : rl.rlim_cur;
+    if (with_desc) out_printf("%-26s (-%c) ", limit_tab[idx].desc, limit_tab[idx].opt);
+    if (v == RLIM_INFINITY) out_printf("unlimited\n");
+    else out_printf("%llu\n", (unsigned long long)(v / limit_tab[idx].unit));
+}
+
+// ulimit [-S|-H] [-a] [-X [N]]...: without a command, the shell's own
+// limits (inherited by every later job). No option means -f.
+int builtin_ulimit(char **args)
+{
+    placement_t pl;
+    memset(&pl, 0, sizeof(pl));
+    int queries;
+    int used = parse_ulimit(args, &pl, &queries);
+    if (used < 0) return 2;
+    if (args[used]) {
+        fprintf(stderr, "myshell: ulimit: %s: invalid limit\n", args[used]);
+        return 2;
+    }
+    int hard = 0;
+    for (int i = 1; i < used; i++)
+        if (args[i][0] == '-' && strchr(args[i], 'H') && !strchr(args[i], 'S')) hard = 1;
+    int rc = 0;
+    for (int i = 0; i < pl.nlimits; i++)
+        if (apply_limit(pl.limits[i].idx, pl.limits[i].which, pl.limits[i].val) < 0) {
+            fprintf(stderr, "myshell: ulimit -%c: %s\n", limit_tab[pl.limits[i].idx].opt, strerror(errno));
+            rc = 1;
+        }
+    // queries: -a shows everything, -X without a value shows that one
+    for (int i = 1; i < used; i++) {
+        if (args[i][0] != '-') continue;
+        for (const char *o = args[i] + 1; *o; o++) {
+            if (*o == 'a') {
+                for (size_t k = 0; k < NLIMITS; k++) print_limit(k, hard, 1);
+            } else if (*o != 'S' && *o != 'H') {
+                int idx = limit_index(*o);
+                rlim_t v;
+                if (!o[1] && args[i+1] && parse_limit(args[i+1], (size_t)idx, &v) == 0) { i++; break; }
+                print_limit((size_t)idx, hard, queries > 1);
+            }
+        }
+    }
+    if (used == 1 || (pl.nlimits == 0 && queries == 0))
+        print_limit((size_t)limit_index('f'), hard, 0);
+    return rc;
+}
@@ -1,55 +1,435 @@
 #include "shell.h"
-// No heavy scanning for PATH to keep completion responsive
+// PATH commands complete from an index built off the main thread (cmdindex.c)
+
+int shell_interactive = 0;
+int exec_tail = 0;
+
+/* ------------ Shell options (set -o) ------------ */
+int  opt_spawn = 1;
+int  opt_utils = 1;
+long opt_pipesize = 0;
+
+static struct {
+    const char *name;
+    int        *value;
+    void      (*changed)(void);
+} shell_opts[] = {
+    { "spawn", &opt_spawn, NULL },
+    { "utils", &opt_utils, NULL },
+    { "xtrace", &opt_xtrace, trace_setup },
+    { NULL, NULL, NULL }
+};
+
+// Numeric options: 'set -o name N' sets, 'set +o name' restores 0 (default)
+static struct {
+    const char *name;
+    long       *value;
+    void      (*changed)(void);
+} shell_vals[] = {
+    { "pipesize", &opt_pipesize, NULL },
+    { "histsize", &opt_histsize, hist_set_size },
+    { "tracesize", &opt_tracesize, trace_setup },
+    { NULL, NULL, NULL }
+};
+
+int parse_size(const char *s, long *out)
+{
+    char *end = NULL;
+    errno = 0;
+    long v = strtol(s, &end, 10);
+    if (end == s || errno != 0 || v < 0) return -1;
+    if (*end == 'k' || *end == 'K') { v <<= 10; end++; }
+    else if (*end == 'm' || *end == 'M') { v <<= 20; end++; }
+    if (*end != '\0') return -1;
+    *out = v;
+    return 0;
+}
+
+int set_option(const char *name, const char *value, int on)
+{
+    for (int i = 0; shell_vals[i].name; i++) {
+        if (strcmp(shell_vals[i].name, name) != 0)
+            continue;
+        long v = 0;
+        if (on && (!value || parse_size(value, &v) < 0)) {
+            fprintf(stderr, "myshell: set: usage: set -o %s N[K|M]\n", name);
+            return -1;
+        }
+        *shell_vals[i].value = v;
+        if (shell_vals[i].changed) shell_vals[i].changed();
+        return 0;
+    }
+    for (int i = 0; shell_opts[i].name; i++) {
+        if (strcmp(shell_opts[i].name, name) == 0) {
+            *shell_opts[i].value = on;
+            if (shell_opts[i].changed) shell_opts[i].changed();
+            return 0;
+        }
+    }
+    fprintf(stderr, "myshell: set: %s: invalid option name\n", name);
+    return -1;
+}
 
-/* ------------ Background jobs list ------------ */
-static job_t jobs[MAXJOBS];
-static int   jobs_count = 0;
+void print_options(void)
+{
+    for (int i = 0; shell_opts[i].name; i++)
+        out_printf("%-12s %s\n", shell_opts[i].name, *shell_opts[i].value ? "on" : "off");
+    for (int i = 0; shell_vals[i].name; i++) {
+        if (*shell_vals[i].value)
+            out_printf("%-12s %ld\n", shell_vals[i].name, *shell_vals[i].value);
+        else
+            out_printf("%-12s default\n", shell_vals[i].name);
+    }
+}
 
 /* ------------ Variables (v8) ------------ */
-static var_t *vars_head = NULL;
+// Open-addressing table (linear probing, power-of-two capacity). Names are
+// interned in a bump-allocated pool since slots are never removed ('unset'
+// only flags them), and each value buffer is reused in place whenever the
+// new value fits.
+static var_t *vars_tab = NULL;
+static size_t vars_cap = 0;
+static size_t vars_count = 0;
+
+// Cached "NAME=VALUE" array of the exported variables for exec
+static char **envp_cache = NULL;
+static int    env_dirty = 1;
+
+#define NAME_POOL_CHUNK 4096
+static char  *name_pool = NULL;
+static size_t name_pool_left = 0;
+
+size_t str_hash(const char *s)
+{
+    // FNV-1a
+    size_t h = 14695981039346656037UL;
+    while (*s) { h ^= (unsigned char)*s++; h *= 1099511628211UL; }
+    return h;
+}
+
+// Same hash over the first n bytes (names inside a command line)
+static size_t mem_hash(const char *s, size_t n)
+{
+    size_t h = 14695981039346656037UL;
+    while (n--) { h ^= (unsigned char)*s++; h *= 1099511628211UL; }
+    return h;
+}
+
+static const char* intern_name(const char *name)
+{
+    size_t len = strlen(name) + 1;
+    if (len > name_pool_left) {
+        size_t sz = len > NAME_POOL_CHUNK ? len : NAME_POOL_CHUNK;
+        name_pool = (char*)malloc(sz);
+        if (!name_pool) { perror("malloc"); name_pool_left = 0; return NULL; }
+        name_pool_left = sz;
+    }
+    char *p = name_pool;
+    memcpy(p, name, len);
+    name_pool += len;
+    name_pool_left -= len;
+    return p;
+}
 
-static int is_valid_var_start(char c) {
+static var_t* var_slot(const char *name, size_t h)
+{
+    size_t mask = vars_cap - 1;
+    size_t i = h & mask;
+    while (vars_tab[i].name && (vars_tab[i].hash != h || strcmp(vars_tab[i].name, name) != 0))
+        i = (i + 1) & mask;
+    return &vars_tab[i];
+}
+
+static int vars_grow(void)
+{
+    size_t ncap = vars_cap ? vars_cap * 2 : 64;
+    var_t *ntab = (var_t*)calloc(ncap, sizeof(var_t));
+    if (!ntab) { perror("calloc"); return -1; }
+    var_t *old = vars_tab;
+    size_t ocap = vars_cap;
+    vars_tab = ntab;
+    vars_cap = ncap;
+    for (size_t i = 0; i < ocap; i++)
+        if (old[i].name) *var_slot(old[i].name, old[i].hash) = old[i];
+    free(old);
+    return 0;
+}
+
+int is_valid_var_start(char c) {
     return (c == '_' || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'));
 }
 
-static int is_valid_var_char(char c) {
+int is_valid_var_char(char c) {
     return is_valid_var_start(c) || (c >= '0' && c <= '9');
 }
 
+// PATH drives command lookup: keep the shell's own environment in sync
+// and drop every cached resolution made under the old value
+static void path_changed(const char *value)
+{
+    if (value) setenv("PATH", value, 1);
+    else unsetenv("PATH");
+    path_cache_clear();
+    cmd_index_path_changed();
+}
+
+static var_t* var_find(const char *name)
+{
+    if (vars_cap == 0) return NULL;
+    var_t *v = var_slot(name, str_hash(name));
+    return v->name ? v : NULL;
+}
+
 void set_var(const char *name, const char *value)
 {
     if (!name) return;
-    // find existing
-    for (var_t *v = vars_head; v; v = v->next) {
-        if (strcmp(v->name, name) == 0) {
-            free(v->value);
-            v->value = strdup(value ? value : "");
-            return;
-        }
+    if (strcmp(name, "PATH") == 0) path_changed(value ? value : "");
+    if (!value) value = "";
+    size_t vlen = strlen(value) + 1;
+    size_t h = str_hash(name);
+
+    // keep load factor <= 1/2
+    if ((vars_count + 1) * 2 > vars_cap && vars_grow() < 0) return;
+    var_t *v = var_slot(name, h);
+    if (!v->name) {
+        const char *iname = intern_name(name);
+        if (!iname) return;
+        v->name = iname;
+        v->hash = h;
+        v->value = NULL;
+        v->cap = 0;
+        v->flags = 0;
+        vars_count++;
+    }
+    v->flags &= ~VAR_UNSET;
+    if (v->flags & VAR_EXPORTED) env_dirty = 1;
+    if (vlen > v->cap) {
+        size_t ncap = vlen < 16 ? 16 : vlen;
+        char *nv = (char*)realloc(v->value, ncap);
+        if (!nv) { perror("realloc"); return; }
+        v->value = nv;
+        v->cap = ncap;
     }
-    // new
-    var_t *nv = (var_t*)calloc(1, sizeof(var_t));
-    if (!nv) { perror("calloc"); return; }
-    nv->name = strdup(name);
-    nv->value = strdup(value ? value : "");
-    nv->next = vars_head;
-    vars_head = nv;
+    memcpy(v->value, value, vlen);
 }
 
 const char* get_var(const char *name)
 {
-    if (!name) return "";
-    for (var_t *v = vars_head; v; v = v->next) {
-        if (strcmp(v->name, name) == 0) return v->value ? v->value : "";
+    if (!name || vars_cap == 0) return "";
+    var_t *v = var_slot(name, str_hash(name));
+    return v->name ? v->value : ""; // undefined expands to empty
+}
+
+// Lookup by a name that is not NUL-terminated, e.g. "$X" inside a word
+const char* get_varn(const char *name, size_t len)
+{
+    if (vars_cap == 0) return "";
+    size_t h = mem_hash(name, len);
+    size_t mask = vars_cap - 1;
+    for (size_t i = h & mask; vars_tab[i].name; i = (i + 1) & mask) {
+        const var_t *v = &vars_tab[i];
+        if (v->hash == h && strncmp(v->name, name, len) == 0 && v->name[len] == '\0')
+            return v->value;
     }
-    return ""; // undefined expands to empty
+    return "";
+}
+
+static int var_cmp(const void *a, const void *b)
+{
+    return strcmp((*(const var_t* const*)a)->name, (*(const var_t* const*)b)->name);
+}
+
+// Set variables with all of the given flags, sorted, one per line
+static void list_vars(int flags, const char *prefix)
+{
+    if (vars_count == 0) return;
+    const var_t **sorted = (const var_t**)malloc(vars_count * sizeof(*sorted));
+    if (!sorted) { perror("malloc"); return; }
+    size_t n = 0;
+    for (size_t i = 0; i < vars_cap; i++)
+        if (vars_tab[i].name && !(vars_tab[i].flags & VAR_UNSET) && (vars_tab[i].flags & flags) == flags)
+            sorted[n++] = &vars_tab[i];
+    qsort(sorted, n, sizeof(*sorted), var_cmp);
+    for (size_t i = 0; i < n; i++)
+        out_printf("%s%s=%s\n", prefix, sorted[i]->name, sorted[i]->value);
+    free(sorted);
 }
 
 void print_vars(void)
 {
-    for (var_t *v = vars_head; v; v = v->next) {
-        printf("%s=%s\n", v->name, v->value ? v->value : "");
+    list_vars(0, "");
+}
+
+// Every NAME=VALUE of the inherited environment becomes an exported
+// variable (entries that are not valid names are not passed on)
+void import_environ(void)
+{
+    extern char **environ;
+    for (char **e = environ; *e; e++) {
+        const char *eq = strchr(*e, '=');
+        size_t nlen = eq ? (size_t)(eq - *e) : 0;
+        if (!eq || nlen == 0 || nlen >= 256 || !is_valid_var_start(**e)) continue;
+        char name[256];
+        memcpy(name, *e, nlen);
+        name[nlen] = '\0';
+        int ok = 1;
+        for (size_t i = 1; i < nlen; i++) ok &= is_valid_var_char(name[i]);
+        if (!ok) continue;
+        set_var(name, eq + 1);
+        var_t *v = var_find(name);
+        if (v) v->flags |= VAR_EXPORTED;
+    }
+    env_dirty = 1;
+}
+
+// The envp for exec: built in one malloc'd block, reused until an
+// exported variable is assigned, exported or unset. Call it before
+// forking: the child must not allocate.
+char** shell_envp(void)
+{
+    static char *empty_envp[] = { NULL };
+    if (!env_dirty && envp_cache) return envp_cache;
+    size_t cnt = 0, bytes = 0;
+    for (size_t i = 0; i < vars_cap; i++) {
+        const var_t *v = &vars_tab[i];
+        if (v->name && (v->flags & (VAR_EXPORTED | VAR_UNSET)) == VAR_EXPORTED) {
+            cnt++;
+            bytes += strlen(v->name) + strlen(v->value) + 2;
+        }
+    }
+    char **envp = (char**)malloc((cnt + 1) * sizeof(char*) + bytes);
+    if (!envp) { perror("malloc"); return envp_cache ? envp_cache : empty_envp; }
+    char *s = (char*)(envp + cnt + 1);
+    size_t k = 0;
+    for (size_t i = 0; i < vars_cap; i++) {
+        const var_t *v = &vars_tab[i];
+        if (v->name && (v->flags & (VAR_EXPORTED | VAR_UNSET)) == VAR_EXPORTED) {
+            envp[k++] = s;
+            s += sprintf(s, "%s=%s", v->name, v->value) + 1;
+        }
+    }
+    envp[k] = NULL;
+    free(envp_cache);
+    envp_cache = envp;
+    env_dirty = 0;
+    return envp;
+}
+
+// export [-n] [NAME[=VALUE]...]: no names lists the exported variables;
+// -n stops exporting
+int builtin_export(char **args)
+{
+    int unexport = args[1] && strcmp(args[1], "-n") == 0;
+    char **names = args + 1 + unexport;
+    if (!*names) {
+        list_vars(VAR_EXPORTED, "export ");
+        return 0;
+    }
+    int rc = 0;
+    for (; *names; names++) {
+        const char *eq = strchr(*names, '=');
+        size_t nlen = eq ? (size_t)(eq - *names) : strlen(*names);
+        char name[256];
+        int ok = nlen > 0 && nlen < sizeof(name) && is_valid_var_start(**names);
+        for (size_t i = 1; ok && i < nlen; i++) ok = is_valid_var_char((*names)[i]);
+        if (!ok) {
+            fprintf(stderr, "myshell: export: '%s': not a valid identifier\n", *names);
+            rc = 1;
+            continue;
+        }
+        memcpy(name, *names, nlen);
+        name[nlen] = '\0';
+        var_t *v = var_find(name);
+        if (eq) {
+            set_var(name, eq + 1);
+            v = var_find(name);
+        } else if (!v && !unexport) {
+            set_var(name, "");             // exported, but with no value yet:
+            v = var_find(name);            // kept out of envp until assigned
+            if (v) v->flags |= VAR_UNSET;
+        }
+        if (!v) continue;
+        if (unexport) v->flags &= ~VAR_EXPORTED;
+        else v->flags |= VAR_EXPORTED;
+        env_dirty = 1;
+    }
+    return rc;
+}
+
+// unset NAME...: the variable reads as empty and leaves the environment
+int builtin_unset(char **args)
+{
+    for (int i = 1; args[i]; i++) {
+        var_t *v = var_find(args[i]);
+        if (!v || (v->flags & VAR_UNSET)) continue;
+        if (v->flags & VAR_EXPORTED) env_dirty = 1;
+        v->flags = VAR_UNSET;
+        v->value[0] = '\0';
+        if (strcmp(args[i], "PATH") == 0) path_changed(NULL);
+    }
+    return 0;
+}
+
+// read [-r] [NAME...]: one line of stdin, split at blanks; the last NAME
+// (REPLY if none) takes the rest of the line. -r is accepted ('\' is not
+// special here anyway). A pipe is read a byte at a time so nothing past
+// the newline is taken from the next reader (a coprocess's next answer,
+// the rest of a loop's input); a seekable file is read in blocks and its
+// offset moved back to just after the line. Status 1 at end of input.
+int builtin_read(char **args)
+{
+    static char *line = NULL;   // kept for the next call: no malloc per line
+    static size_t cap = 0;
+    static char *reply[] = { "REPLY", NULL };
+    char **names = args + 1;
+    if (*names && strcmp(*names, "-r") == 0) names++;
+    if (!*names) names = reply;
+    for (char **n = names; *n; n++) {
+        int ok = is_valid_var_start(**n);
+        for (const char *c = *n + 1; ok && *c; c++) ok = is_valid_var_char(*c);
+        if (!ok) {
+            fprintf(stderr, "myshell: read: '%s': not a valid identifier\n", *n);
+            return 2;
+        }
+    }
+    off_t pos = lseek(STDIN_FILENO, 0, SEEK_CUR);
+    size_t len = 0;
+    int eof = 0;
+    for (;;) {
+        if (cap - len < 256) {
+            size_t ncap = cap ? cap * 2 : 1024;
+            char *nl = (char*)realloc(line, ncap);
+            if (!nl) { perror("realloc"); return 1; }
+            line = nl;
+            cap = ncap;
+        }
+        ssize_t r = read(STDIN_FILENO, line + len, pos >= 0 ? cap - len - 1 : 1);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) { perror("myshell: read"); return 1; }
+        if (r == 0) { eof = 1; break; }
+        char *nl = (char*)memchr(line + len, '\n', (size_t)r);
+        if (nl) {
+            if (pos >= 0) lseek(STDIN_FILENO, pos + (nl - line) + 1, SEEK_SET);
+            len = (size_t)(nl - line);
+            break;
+        }
+        len += (size_t)r;
     }
+    line[len] = '\0';
+    char *s = line;
+    for (; *names; names++) {
+        while (*s == ' ' || *s == '\t') s++;
+        char *w = s;
+        if (names[1]) {
+            while (*s && *s != ' ' && *s != '\t') s++;
+            if (*s) *s++ = '\0';
+        } else {
+            char *e = w + strlen(w);
+            while (e > w && (e[-1] == ' ' || e[-1] == '\t')) *--e = '\0';
+        }
+        set_var(*names, w);
+    }
+    return eof;
 }
 
 static int is_assignment_token(const char *tok)
@@ -70,250 +450,211 @@ static int is_assignment_token(const char *tok)
     return 1;
 }
 
-void process_assignments(char **arglist)
+// Prefix assignments in effect: what each variable was before
+typedef struct {
+    const char *name;  // interned
+    char       *old;   // malloc'd value, NULL if it was unset
+    int         flags;
+} saved_var_t;
+
+static saved_var_t *saved_vars = NULL;
+static size_t       nsaved = 0, saved_cap = 0;
+
+// Returns -1 if there was no room to remember it
+static int save_var(const char *name)
 {
-    if (!arglist) return;
-    for (int i = 0; arglist[i] != NULL; ) {
-        char *tok = arglist[i];
-        if (is_assignment_token(tok)) {
-            // split into name and value
-            char *eq = strchr(tok, '=');
-            *eq = '\0';
-            const char *name = tok;
-            const char *value = eq + 1;
-            set_var(name, value);
-            // remove token i
-            free(tok);
-            int j = i;
-            while (arglist[j] != NULL) {
-                arglist[j] = arglist[j+1];
-                j++;
-            }
-            // do not increment i; now points to next element
-            continue;
-        }
-        i++;
+    if (nsaved == saved_cap) {
+        size_t ncap = saved_cap ? saved_cap * 2 : 8;
+        saved_var_t *ns = (saved_var_t*)realloc(saved_vars, ncap * sizeof(saved_var_t));
+        if (!ns) { perror("realloc"); return -1; }
+        saved_vars = ns;
+        saved_cap = ncap;
     }
+    const var_t *v = var_find(name);
+    int isset = v && !(v->flags & VAR_UNSET);
+    saved_vars[nsaved++] = (saved_var_t){ v ? v->name : NULL, isset ? strdup(v->value) : NULL,
+                                          v ? v->flags : VAR_UNSET };
+    return 0;
 }
 
-void expand_variables(char **arglist)
+void process_assignments(char **arglist)
 {
     if (!arglist) return;
-    for (int i = 0; arglist[i] != NULL; i++) {
-        char *tok = arglist[i];
-        if (!tok || tok[0] == '\0') continue;
-        // skip operator tokens
-        if ((tok[0] == '|' || tok[0] == '<' || tok[0] == '>') && tok[1] == '\0') continue;
-
-        if (tok[0] == '$') {
-            const char *name = tok + 1;
-            if (*name == '\0') continue; // lone '$'
-            // parse var name letters/digits/_ only
-            int k = 0;
-            while (name[k] && is_valid_var_char(name[k])) k++;
-            // Only expand if token is exactly $NAME (no suffix)
-            if (name[k] == '\0') {
-                const char *val = get_var(name);
-                char *rep = strdup(val ? val : "");
-                if (!rep) { perror("strdup"); continue; }
-                free(arglist[i]);
-                arglist[i] = rep;
+    int n = 0;
+    while (arglist[n] && is_assignment_token(arglist[n])) n++;
+    if (n == 0) return;
+    int prefix = arglist[n] != NULL;
+    for (int i = 0; i < n; i++) {
+        // split into name and value; the token itself may belong to a
+        // parsed command that runs again (loop bodies)
+        const char *tok = arglist[i];
+        const char *eq = strchr(tok, '=');
+        char stackbuf[64];
+        size_t nlen = (size_t)(eq - tok);
+        char *name = nlen < sizeof(stackbuf) ? stackbuf : (char*)malloc(nlen + 1);
+        if (!name) { perror("malloc"); return; }
+        memcpy(name, tok, nlen);
+        name[nlen] = '\0';
+        // an assignment that could not be saved would outlive the command:
+        // leave that variable alone
+        if (prefix && save_var(name) < 0) {
+            if (name != stackbuf) free(name);
+            continue;
+        }
+        set_var(name, eq + 1);
+        if (prefix) {
+            var_t *v = var_find(name);
+            if (v) {
+                // the saved entry needs the interned name if v is new
+                saved_vars[nsaved - 1].name = v->name;
+                v->flags |= VAR_EXPORTED;
+                env_dirty = 1;
             }
         }
+        if (name != stackbuf) free(name);
     }
+    // drop the assignment words from the argv
+    int j = 0;
+    while ((arglist[j] = arglist[j + n]) != NULL) j++;
 }
 
-void add_job(pid_t pid, const char* cmd)
+// Undo the prefix assignments of the command that just ran
+void restore_assignments(void)
 {
-    if (pid <= 0) return;
-    if (jobs_count >= MAXJOBS) {
-        fprintf(stderr, "myshell: job table full, cannot track PID %d\n", (int)pid);
-        return;
-    }
-    jobs[jobs_count].pid = pid;
-    strncpy(jobs[jobs_count].cmd, cmd ? cmd : "(unknown)", sizeof(jobs[jobs_count].cmd) - 1);
-    jobs[jobs_count].cmd[sizeof(jobs[jobs_count].cmd) - 1] = '\0';
-    jobs_count++;
-}
-
-void remove_job(pid_t pid)
-{
-    for (int i = 0; i < jobs_count; i++) {
-        if (jobs[i].pid == pid) {
-            // compact
-            for (int j = i + 1; j < jobs_count; j++) jobs[j-1] = jobs[j];
-            jobs_count--;
-            return;
+    while (nsaved > 0) {
+        saved_var_t *s = &saved_vars[--nsaved];
+        if (!s->name) continue;
+        set_var(s->name, s->old ? s->old : "");
+        var_t *v = var_find(s->name);
+        if (v) {
+            if (!s->old) v->value[0] = '\0';
+            v->flags = s->flags;
         }
+        env_dirty = 1;
+        if (!s->old && strcmp(s->name, "PATH") == 0) path_changed(NULL);
+        free(s->old);
     }
 }
 
-void print_jobs(void)
-{
-    if (jobs_count == 0) {
-        printf("(no background jobs)\n");
-        return;
-    }
-    for (int i = 0; i < jobs_count; i++) {
-        printf("[%d] %d  %s\n", i + 1, (int)jobs[i].pid, jobs[i].cmd);
-    }
-}
-
-void reap_background(void)
-{
-    int status;
-    pid_t pid;
-    // Reap all finished children without blocking
-    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
-        // Optional: uncomment for verbose completion logging:
-        // if (WIFEXITED(status)) {
-        //     fprintf(stderr, "[bg] pid %d exited with %d\n", (int)pid, WEXITSTATUS(status));
-        // } else if (WIFSIGNALED(status)) {
-        //     fprintf(stderr, "[bg] pid %d killed by signal %d\n", (int)pid, WTERMSIG(status));
-        // }
-        remove_job(pid);
-    }
-}
-
-/* ------------ History printing via Readline ------------ */
-void history_print(void)
-{
-    if (history_length == 0) {
-        printf("(history empty)\n");
-        return;
-    }
-    HIST_ENTRY **list = history_list();
-    if (!list) {
-        printf("(history unavailable)\n");
-        return;
-    }
-    for (int i = 0; list[i] != NULL; i++) {
-        printf("%d  %s\n", i + 1, list[i]->line);
-    }
-}
-
-/* ------------ Readline completion (built-ins + default filenames) ------------ */
-static const char* builtin_cmds[] = { "cd", "pwd", "help", "exit", "jobs", "history", "set", NULL };
+/* ------------ Readline completion (commands + default filenames) ------------ */
+static const char* builtin_cmds[] = { "cd", "pwd", "help", "exit", "jobs", "history", "set", "hash", "time", "fg", "bg", "wait", "parallel", "pipesize", "tee",
+                                      "affinity", "ulimit", "trace", "export", "unset", "read", "coproc",
+                                      "echo", "printf", "test", "[", "true", "false", NULL };
 
-static char* builtin_generator(const char* text, int state)
+// Builtins first, then PATH commands from the index
+static char* command_generator(const char* text, int state)
 {
     static int idx;
+    static char **path_cmds;
+    static size_t pidx;
     size_t len = strlen(text);
-    if (state == 0) idx = 0;
+    if (state == 0) {
+        idx = 0;
+        free(path_cmds); // left over if readline stopped early
+        path_cmds = cmd_index_complete(text);
+        pidx = 0;
+    }
     while (builtin_cmds[idx]) {
         const char* cand = builtin_cmds[idx++];
         if (strncmp(cand, text, len) == 0)
             return strdup(cand);
     }
+    if (path_cmds && path_cmds[pidx])
+        return path_cmds[pidx++]; // readline frees it
+    free(path_cmds);
+    path_cmds = NULL;
     return NULL;
 }
 
+// The word at start names a command: first on the line, or after an
+// operator or a keyword that starts a command
+static int command_position(int start)
+{
+    static const char *kw[] = { "then", "do", "else", "elif", "if", "while", "until", "!", "time", NULL };
+    int i = start;
+    while (i > 0 && (rl_line_buffer[i-1] == ' ' || rl_line_buffer[i-1] == '\t')) i--;
+    if (i == 0) return 1;
+    char c = rl_line_buffer[i-1];
+    if (c == ';' || c == '&' || c == '|') return 1;
+    int e = i;
+    while (i > 0 && rl_line_buffer[i-1] != ' ' && rl_line_buffer[i-1] != '\t' &&
+           rl_line_buffer[i-1] != ';' && rl_line_buffer[i-1] != '&' && rl_line_buffer[i-1] != '|') i--;
+    for (int k = 0; kw[k]; k++)
+        if ((size_t)(e - i) == strlen(kw[k]) && strncmp(rl_line_buffer + i, kw[k], (size_t)(e - i)) == 0)
+            return command_position(i);
+    return 0;
+}
+
 char** myshell_completion(const char* text, int start, int end)
 {
     (void)end;
-    // At start of line, complete built-ins. If user typed a path component, let default filename completion handle it.
-    if (start == 0) {
+    // Command names in command position; a path component gets default
+    // filename completion
+    if (command_position(start)) {
         if (strchr(text, '/')) return NULL; // fallback to default filename completion
-        return rl_completion_matches(text, builtin_generator);
+        return rl_completion_matches(text, command_generator);
     }
     // Non-first word: fall back to default filename completion (NULL tells readline to do default)
     return NULL;
 }
 
-/* ------------ Tokenize command string ------------ */
-char** tokenize(char* cmdline)
+/* ------------ Handle built-in shell commands ------------ */
+int is_builtin(const char *name)
 {
-    if (cmdline == NULL || cmdline[0] == '\0' || cmdline[0] == '\n')
-        return NULL;
-
-    char** arglist = (char**) malloc(sizeof(char*) * (MAXARGS + 1));
-    if (!arglist) { perror("malloc"); return NULL; }
-    for (int i = 0; i < MAXARGS + 1; i++) arglist[i] = NULL;
-
-    int argnum = 0;
-    const char *cp = cmdline;
-
-    while (*cp != '\0' && argnum < MAXARGS)
-    {
-        // Skip whitespace
-        while (*cp == ' ' || *cp == '\t') cp++;
-        if (*cp == '\0' || *cp == '\n') break;
-
-        // If special operator, emit as its own token
-        if (*cp == '<' || *cp == '>' || *cp == '|') {
-            char *tok = (char*)calloc(2, 1);
-            if (!tok) { perror("calloc"); break; }
-            tok[0] = *cp;
-            tok[1] = '\0';
-            arglist[argnum++] = tok;
-            cp++;
-            continue;
-        }
-
-        // Otherwise, read a word possibly containing quoted substrings
-        char buf[ARGLEN];
-        int len = 0;
-        while (*cp != '\0' && *cp != '\n' && *cp != ' ' && *cp != '\t' && *cp != '<' && *cp != '>' && *cp != '|') {
-            if (*cp == '"') {
-                cp++; // skip opening quote
-                while (*cp != '\0' && *cp != '"') {
-                    if (len < ARGLEN - 1) buf[len++] = *cp;
-                    cp++;
-                }
-                if (*cp == '"') cp++; // skip closing quote
-            } else if (*cp == '\'') {
-                cp++; // skip opening single quote
-                while (*cp != '\0' && *cp != '\'') {
-                    if (len < ARGLEN - 1) buf[len++] = *cp;
-                    cp++;
-                }
-                if (*cp == '\'') cp++; // skip closing single quote
-            } else {
-                if (len < ARGLEN - 1) buf[len++] = *cp;
-                cp++;
-            }
-        }
-        buf[len] = '\0';
-        if (len > 0) {
-            arglist[argnum] = strdup(buf);
-            if (!arglist[argnum]) { perror("strdup"); break; }
-            argnum++;
-        }
-    }
-
-    if (argnum == 0)
-    {
-        for (int i = 0; i < MAXARGS + 1; i++)
-            if (arglist[i]) free(arglist[i]);
-        free(arglist);
-        return NULL;
-    }
-
-    arglist[argnum] = NULL;
-    return arglist;
+    // 'time' and 'pipesize' complete like builtins but are prefixes
+    // handled by execute()
+    if (strcmp(name, "time") == 0 || strcmp(name, "pipesize") == 0)
+        return 0;
+    // 'set +o utils' sends the small utilities back to PATH (for comparison)
+    if (!opt_utils && (strcmp(name, "echo") == 0 || strcmp(name, "printf") == 0 ||
+                       strcmp(name, "test") == 0 || strcmp(name, "[") == 0 ||
+                       strcmp(name, "true") == 0 || strcmp(name, "false") == 0 ||
+                       strcmp(name, "tee") == 0))
+        return 0;
+    for (int i = 0; builtin_cmds[i]; i++)
+        if (strcmp(builtin_cmds[i], name) == 0)
+            return 1;
+    return 0;
 }
 
-/* ------------ Handle built-in shell commands ------------ */
-int handle_builtin(char **args)
+// Run a builtin (is_builtin(args[0]) must hold) and return its exit
+// status. Output goes through the out_* buffer, flushed before returning.
+int run_builtin(char **args)
 {
-    if (args == NULL || args[0] == NULL)
-        return 0;
+    int rc = 0;
 
-    /* exit */
+    /* exit [N]: N, or the status of the last command */
     if (strcmp(args[0], "exit") == 0)
     {
-        printf("Exiting myshell...\n");
-        exit(0);
+        int code = last_status;
+        if (args[1]) {
+            char *end;
+            errno = 0;
+            long n = strtol(args[1], &end, 10);
+            if (end == args[1] || *end || errno || args[2]) {
+                fprintf(stderr, "myshell: exit: usage: exit [N]\n");
+                code = 2;
+            } else {
+                code = (int)(n & 0xff);
+            }
+        }
+        if (shell_interactive)
+            out_printf("Exiting myshell...\n");
+        out_flush();
+        exit(code);
     }
 
     /* cd */
     else if (strcmp(args[0], "cd") == 0)
     {
-        if (args[1] == NULL)
+        if (args[1] == NULL) {
             fprintf(stderr, "myshell: expected argument to \"cd\"\n");
-        else if (chdir(args[1]) != 0)
+            rc = 1;
+        } else if (chdir(args[1]) != 0) {
             perror("myshell");
-        return 1;
+            rc = 1;
+        } else
+            path_cache_clear(); // relative PATH entries now resolve elsewhere
     }
 
     /* pwd */
@@ -321,47 +662,180 @@ int handle_builtin(char **args)
     {
         char cwd[1024];
         if (getcwd(cwd, sizeof(cwd)) != NULL)
-            printf("%s\n", cwd);
-        else
+            out_printf("%s\n", cwd);
+        else {
             perror("myshell");
-        return 1;
+            rc = 1;
+        }
     }
 
     /* help */
     else if (strcmp(args[0], "help") == 0)
     {
-        printf("myshell built-in commands:\n");
-        printf("  cd [dir]   - change directory\n");
-        printf("  pwd        - print current working directory\n");
-        printf("  help       - show this help message\n");
-        printf("  exit       - exit the shell\n");
-        printf("  jobs       - (not yet implemented)\n");
-        printf("  history    - show command history\n");
-        printf("  !n         - re-execute nth command from history\n");
-        printf("  set        - list shell variables\n");
-        return 1;
-    }
-
-    /* jobs (placeholder) */
+        out_printf("myshell built-in commands:\n"
+                   "  cd [dir]   - change directory\n"
+                   "  pwd        - print current working directory\n"
+                   "  help       - show this help message\n"
+                   "  exit [N]   - exit the shell with status N (default: the last command's)\n"
+                   "  jobs [-l]  - list background jobs (-l: with resource usage)\n"
+                   "  fg/bg [%%n] - resume a job in the foreground/background\n"
+                   "  wait [%%n]  - wait for one or all background jobs\n"
+                   "  parallel [-j N] cmd {} ::: args - run cmd per arg, N at a time\n"
+                   "  time cmd   - report wall/user/sys time and max RSS per stage\n"
+                   "  history [n] - show command history (the last n entries)\n"
+                   "  !n         - re-execute nth command from history\n"
+                   "  set        - list shell variables\n"
+                   "  export [-n] [NAME[=VALUE]...], unset NAME... - environment of commands\n"
+                   "  NAME=VALUE cmd - set NAME for this command only\n"
+                   "  read [-r] [NAME...] - read a line of stdin into variables (default REPLY)\n"
+                   "  coproc NAME cmd [args] - keep cmd running on two pipes: write with\n"
+                   "             >&$NAME_IN, read with <&$NAME_OUT; coproc [-c NAME] lists/closes\n"
+                   "  hash [-r] [name...] - list, clear or prefill the command cache\n"
+                   "  set -o/+o  - list, enable or disable shell options\n"
+                   "  set -o histsize N - history entries kept in memory (default 1000)\n"
+                   "  set -o pipesize N - pipe capacity in bytes for new pipelines\n"
+                   "  pipesize N cmd | ... - pipe capacity for this pipeline only\n"
+                   "  echo, printf, test/[, true, false - run in the shell (set +o utils: use PATH)\n"
+                   "  affinity CPUS cmd | @CPUS cmd - pin a pipeline / one stage (e.g. 0-3,8)\n"
+                   "  affinity [CPUS [%%n]] - show or pin the shell, or re-pin a job\n"
+                   "  nice [-n N] cmd, ulimit [-S|-H] -X N cmd - priority and limits per job\n"
+                   "  ulimit [-a] [-X [N]] - show or set the shell's limits (-c -d -f -l -m -n -s -t -u -v)\n"
+                   "  set -o xtrace, trace dump FILE - record fork/exec/wait events, write Chrome trace JSON\n"
+                   "  trace [status|clear], set -o tracesize N - events kept (default 16384)\n"
+                   "  tee [-a] [file...] - copy stdin to stdout and files (splice/tee(2) on pipes;\n"
+                   "      other options and set +o utils: PATH tee)\n"
+                   "  if/then/elif/else/fi, while/until/do/done, for NAME in ...; do/done,\n"
+                   "  a && b, a || b, ! cmd, cmd; cmd - control flow\n"
+                   "  *, ?, [a-z], [!x] - pathname expansion, sorted (quote to keep them literal)\n"
+                   "  diff <(cmd1) <(cmd2), tee >(cmd) - process substitution via /dev/fd/N\n"
+                   "  $(cmd), `cmd` - output of cmd (unquoted: split at blanks; pwd/echo run in the shell)\n"
+                   "  cmd <<EOF ... EOF, <<-EOF (tabs stripped), <<'EOF' (no $), cmd <<< word - inline stdin\n"
+                   "Builtins also work as pipeline stages, e.g. 'history | grep cd'.\n");
+    }
+
+    /* jobs [-l] */
     else if (strcmp(args[0], "jobs") == 0)
     {
-        print_jobs();
-        return 1;
+        print_jobs(args[1] != NULL && strcmp(args[1], "-l") == 0);
+    }
+
+    /* fg / bg / wait */
+    else if (strcmp(args[0], "fg") == 0)
+    {
+        rc = builtin_fg(args);
+    }
+    else if (strcmp(args[0], "bg") == 0)
+    {
+        rc = builtin_bg(args);
+    }
+    else if (strcmp(args[0], "wait") == 0)
+    {
+        rc = builtin_wait(args);
+    }
+
+    /* parallel [-j N] cmd {} ::: args */
+    else if (strcmp(args[0], "parallel") == 0)
+    {
+        rc = builtin_parallel(args);
+    }
+
+    /* echo, printf, test/[, true, false: no fork for script primitives */
+    else if (strcmp(args[0], "echo") == 0)
+    {
+        rc = builtin_echo(args);
+    }
+    else if (strcmp(args[0], "printf") == 0)
+    {
+        rc = builtin_printf(args);
+    }
+    else if (strcmp(args[0], "test") == 0 || strcmp(args[0], "[") == 0)
+    {
+        rc = builtin_test(args);
+    }
+    else if (strcmp(args[0], "true") == 0)
+    {
+        rc = 0;
+    }
+    else if (strcmp(args[0], "false") == 0)
+    {
+        rc = 1;
+    }
+
+    /* affinity / ulimit (the shell's own; as prefixes they are execute()'s) */
+    else if (strcmp(args[0], "affinity") == 0)
+    {
+        rc = builtin_affinity(args);
+    }
+    else if (strcmp(args[0], "ulimit") == 0)
+    {
+        rc = builtin_ulimit(args);
+    }
+    else if (strcmp(args[0], "trace") == 0)
+    {
+        rc = builtin_trace(args);
+    }
+    else if (strcmp(args[0], "export") == 0)
+    {
+        rc = builtin_export(args);
+    }
+    else if (strcmp(args[0], "unset") == 0)
+    {
+        rc = builtin_unset(args);
+    }
+    else if (strcmp(args[0], "read") == 0)
+    {
+        rc = builtin_read(args);
+    }
+    else if (strcmp(args[0], "coproc") == 0)
+    {
+        rc = builtin_coproc(args);
+    }
+
+    /* tee [file...] */
+    else if (strcmp(args[0], "tee") == 0)
+    {
+        rc = builtin_tee(args);
+    }
+
+    /* hash (command path cache) */
+    else if (strcmp(args[0], "hash") == 0)
+    {
+        if (args[1] == NULL)
+            path_cache_print();
+        else if (strcmp(args[1], "-r") == 0)
+            path_cache_clear();
+        else {
+            for (int i = 1; args[i] != NULL; i++)
+                if (!path_lookup(args[i])) {
+                    fprintf(stderr, "myshell: hash: %s: not found\n", args[i]);
+                    rc = 1;
+                }
+        }
     }
 
     /* history */
     else if (strcmp(args[0], "history") == 0)
     {
-        history_print();
-        return 1;
+        history_print(args[1] ? strtol(args[1], NULL, 10) : 0);
     }
 
-        /* set (list variables) */
-        else if (strcmp(args[0], "set") == 0)
-        {
+    /* set (list variables, or toggle options with -o/+o) */
+    else if (strcmp(args[0], "set") == 0)
+    {
+        if (args[1] == NULL)
             print_vars();
-            return 1;
+        else if (strcmp(args[1], "-o") == 0 || strcmp(args[1], "+o") == 0) {
+            if (args[2] == NULL)
+                print_options();
+            else if (set_option(args[2], args[3], args[1][0] == '-') < 0)
+                rc = 1;
+        }
+        else {
+            fprintf(stderr, "myshell: set: usage: set [-o|+o option]\n");
+            rc = 2;
         }
+    }
 
-    return 0;  // not a builtin
+    out_flush();
+    return rc;
 }
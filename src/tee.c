@@ -0,0 +1,188 @@
+#include "shell.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+/* ------------ tee: copy stdin to stdout and files ------------ */
+// tee [-a] [--] [file...]
+//
+// When stdin is a pipe and every output is a pipe or a regular file, the
+// data never passes through user space: tee(2) duplicates the pages queued
+// in stdin into a private pipe per extra output, splice(2) moves them on
+// to that output, and stdout finally takes the original pages with
+// splice(2). 'cmd | tee > file' is thus a zero-copy pipe-to-file sink.
+// Terminals, appending outputs and non-pipe stdin use a plain read/write loop.
+
+#define TEE_BUFSZ (1 << 16)
+
+static int splice_out(int from, int to, size_t n)
+{
+    while (n > 0) {
+        ssize_t r = splice(from, NULL, to, NULL, n, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (r < 0) {
+            if (errno == EINTR && !shell_interrupted) continue;
+            return -1;
+        }
+        if (r == 0) return -1;
+        n -= (size_t)r;
+    }
+    return 0;
+}
+
+// outs[nout - 1] is stdout and consumes stdin; the others read copies
+static int tee_splice(const int *outs, int nout)
+{
+    int (*priv)[2] = NULL;
+    int npriv = nout - 1, made = 0, rc = 0;
+    if (npriv > 0) {
+        priv = (int (*)[2])malloc((size_t)npriv * sizeof(*priv));
+        if (!priv) { perror("malloc"); return 1; }
+        // as large as stdin, so a copy of everything queued always fits
+        int cap = fcntl(STDIN_FILENO, F_GETPIPE_SZ);
+        for (; made < npriv; made++) {
+            if (pipe2(priv[made], O_CLOEXEC) < 0) { perror("tee: pipe"); rc = 1; goto out; }
+            if (cap > 0) fcntl(priv[made][1], F_SETPIPE_SZ, cap);
+        }
+    }
+
+    for (;;) {
+        ssize_t n;
+        if (npriv == 0) {
+            n = splice(STDIN_FILENO, NULL, outs[0], NULL, INT_MAX, SPLICE_F_MOVE | SPLICE_F_MORE);
+        } else {
+            n = tee(STDIN_FILENO, priv[0][1], INT_MAX, 0);
+            for (int i = 1; n > 0 && i < npriv; i++) {
+                if (tee(STDIN_FILENO, priv[i][1], (size_t)n, 0) != n) { n = -1; break; }
+            }
+        }
+        if (n == 0) break; // EOF
+        if (n < 0) {
+            if (errno == EINTR && !shell_interrupted) continue;
+            if (errno != EINTR) perror("tee");
+            rc = 1;
+            break;
+        }
+        if (npriv == 0) continue;
+        for (int i = 0; i < npriv; i++) {
+            if (splice_out(priv[i][0], outs[i], (size_t)n) < 0) { perror("tee"); rc = 1; goto out; }
+        }
+        if (splice_out(STDIN_FILENO, outs[npriv], (size_t)n) < 0) {
+            if (errno != EPIPE) perror("tee");
+            rc = 1;
+            break;
+        }
+    }
+out:
+    for (int i = 0; i < made; i++) { close(priv[i][0]); close(priv[i][1]); }
+    free(priv);
+    return rc;
+}
+
+// A file that fails is reported and dropped (closed, set to -1)
+static int tee_copy(int *outs, int nout)
+{
+    char *buf = (char*)malloc(TEE_BUFSZ);
+    if (!buf) { perror("malloc"); return 1; }
+    int rc = 0;
+    for (;;) {
+        ssize_t n = read(STDIN_FILENO, buf, TEE_BUFSZ);
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR && !shell_interrupted) continue;
+            if (errno != EINTR) perror("tee: read");
+            rc = 1;
+            break;
+        }
+        for (int i = 0; i < nout; i++) {
+            if (outs[i] >= 0 && write_all(outs[i], buf, (size_t)n) < 0) {
+                if (errno != EPIPE) perror("tee: write");
+                rc = 1;
+                if (i == nout - 1) goto out; // stdout gone
+                close(outs[i]);
+                outs[i] = -1;
+            }
+        }
+    }
+out:
+    free(buf);
+    return rc;
+}
+
+// splice() needs a pipe or a regular file, and refuses O_APPEND
+static int splice_ok(int fd)
+{
+    struct stat sb;
+    if (fstat(fd, &sb) < 0 || !(S_ISFIFO(sb.st_mode) || S_ISREG(sb.st_mode)))
+        return 0;
+    int fl = fcntl(fd, F_GETFL);
+    return fl >= 0 && !(fl & O_APPEND);
+}
+
+// An option the builtin does not implement: the whole command goes to the
+// tee in PATH, run by its full path so it is not this builtin again
+static int tee_external(char **args)
+{
+    const char *path = path_lookup("tee");
+    if (!path) {
+        fprintf(stderr, "myshell: tee: %s: unsupported option\n"
+                        "usage: tee [-a] [--] [file...]\n", args[1]);
+        return 2;
+    }
+    int n = 0;
+    while (args[n]) n++;
+    char *argv[n + 1];
+    argv[0] = (char*)path;
+    for (int k = 1; k <= n; k++) argv[k] = args[k];
+    out_flush();
+    int rc;
+    job_t *j = spawn_pipeline(argv, "tee", -1, -1, 0, &rc);
+    if (!j) return rc;
+    rc = job_wait(j, 0);
+    job_remove(j);
+    return rc;
+}
+
+// Only -a is understood here; any other option hands the command to the
+// tee in PATH ('set +o utils' sends every tee there)
+int builtin_tee(char **args)
+{
+    int i = 1, append = 0;
+    for (; args[i] && args[i][0] == '-' && args[i][1]; i++) {
+        if (strcmp(args[i], "--") == 0) { i++; break; }
+        const char *o = args[i] + 1;
+        if (strcmp(o, "-append") == 0) o = "";
+        while (*o == 'a') o++;
+        if (*o) return tee_external(args);
+        append = 1;
+    }
+    int nfiles = 0;
+    while (args[i + nfiles]) nfiles++;
+
+    int *outs = (int*)malloc(((size_t)nfiles + 1) * sizeof(int));
+    if (!outs) { perror("malloc"); return 1; }
+    int nout = 0, rc = 0;
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC);
+    for (int k = 0; k < nfiles; k++) {
+        int fd = open(args[i + k], flags, 0644);
+        if (fd < 0) {
+            fprintf(stderr, "myshell: tee: %s: %s\n", args[i + k], strerror(errno));
+            rc = 1;
+            continue;
+        }
+        outs[nout++] = fd;
+    }
+    outs[nout++] = STDOUT_FILENO;
+
+    struct stat sb;
+    int zero_copy = fstat(STDIN_FILENO, &sb) == 0 && S_ISFIFO(sb.st_mode);
+    for (int k = 0; zero_copy && k < nout; k++)
+        zero_copy = splice_ok(outs[k]);
+
+    int r = zero_copy ? tee_splice(outs, nout) : tee_copy(outs, nout);
+    if (r) rc = r;
+    shell_interrupted = 0;
+    for (int k = 0; k < nout - 1; k++)
+        if (outs[k] >= 0) close(outs[k]);
+    free(outs);
+    return rc;
+}
@@ -0,0 +1,178 @@
+#include "shell.h"
+#include <stdint.h>
+#include <sys/mman.h>
+
+/* ------------ Execution trace (set -o xtrace) ------------ */
+// Timestamped events go into a fixed ring of slots in a MAP_SHARED
+// anonymous mapping, so forked children (a stage between fork and exec, a
+// builtin running as a pipeline stage) record into the same ring as the
+// shell. A slot is claimed with one atomic add and published by writing
+// its sequence number last; the oldest events are overwritten once the
+// ring is full. Call sites test opt_xtrace first, so a disabled trace
+// costs one branch. 'trace dump FILE' writes Chrome trace-event JSON
+// (chrome://tracing, Perfetto): the shell is one row, each child process
+// a row of its own from launch to exit.
+
+#define TRACE_DEFAULT_EVENTS 16384
+
+typedef struct {
+    uint64_t    seq;      // slot index + 1 once the event is complete
+    uint64_t    ts, dur;  // ns, CLOCK_MONOTONIC
+    const char *name;     // a string literal: same address in every child
+    int         tid;      // process the event belongs to
+    int         status;   // exit status, -1 if none
+    char        ph;       // Chrome phase: 'X' span, 'B'/'E' begin/end, 'i' instant
+    char        detail[47];
+} trace_ev_t;
+
+typedef struct {
+    uint64_t   head;      // events ever claimed
+    uint64_t   cap;
+    trace_ev_t ev[];
+} trace_ring_t;
+
+int  opt_xtrace = 0;
+long opt_tracesize = 0;
+
+static trace_ring_t *ring = NULL;
+static size_t ring_bytes = 0;
+
+uint64_t trace_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Map the ring when tracing is turned on or resized ('set -o tracesize N'
+// drops what was recorded). Turning tracing off keeps the events for dump.
+void trace_setup(void)
+{
+    uint64_t cap = opt_tracesize > 0 ? (uint64_t)opt_tracesize : TRACE_DEFAULT_EVENTS;
+    if (ring && ring->cap == cap) return;
+    if (ring) {
+        munmap(ring, ring_bytes);
+        ring = NULL;
+    }
+    if (!opt_xtrace) return;
+    size_t bytes = sizeof(trace_ring_t) + cap * sizeof(trace_ev_t);
+    void *m = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED) {
+        perror("xtrace: mmap");
+        opt_xtrace = 0;
+        return;
+    }
+    ring = (trace_ring_t*)m;
+    ring_bytes = bytes;
+    ring->cap = cap;
+}
+
+// Record one event; tid 0 means the calling process
+void trace_event(char ph, const char *name, pid_t tid, uint64_t ts, uint64_t dur,
+                 int status, const char *detail)
+{
+    if (!ring) return;
+    uint64_t i = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+    trace_ev_t *e = &ring->ev[i % ring->cap];
+    __atomic_store_n(&e->seq, 0, __ATOMIC_RELAXED);
+    e->ts = ts;
+    e->dur = dur;
+    e->name = name;
+    e->tid = tid ? (int)tid : (int)getpid();
+    e->status = status;
+    e->ph = ph;
+    e->detail[0] = '\0';
+    if (detail) {
+        size_t n = strnlen(detail, sizeof(e->detail) - 1);
+        memcpy(e->detail, detail, n);
+        e->detail[n] = '\0';
+    }
+    __atomic_store_n(&e->seq, i + 1, __ATOMIC_RELEASE);
+}
+
+static void json_string(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(f, "\\%c", c);
+        else if (c < 0x20) fprintf(f, "\\u%04x", c);
+        else fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+// Chrome trace-event format; timestamps in microseconds since the oldest
+// event kept. A 'B' (child launch) is labelled with the command, and also
+// names the child's row after it.
+static int trace_dump(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) { perror(path); return 1; }
+    int pid = (int)getpid();
+    uint64_t head = ring ? __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) : 0;
+    uint64_t first = ring && head > ring->cap ? head - ring->cap : 0;
+    uint64_t base = UINT64_MAX;
+    for (uint64_t i = first; i < head; i++) {
+        const trace_ev_t *e = &ring->ev[i % ring->cap];
+        if (__atomic_load_n(&e->seq, __ATOMIC_ACQUIRE) == i + 1 && e->ts < base) base = e->ts;
+    }
+    fprintf(f, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    fprintf(f, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": %d, "
+               "\"args\": {\"name\": \"myshell\"}}", pid, pid);
+    size_t n = 0;
+    for (uint64_t i = first; i < head; i++) {
+        const trace_ev_t *e = &ring->ev[i % ring->cap];
+        if (__atomic_load_n(&e->seq, __ATOMIC_ACQUIRE) != i + 1) continue; // torn or overwritten
+        if (e->ph == 'B' && e->detail[0]) {
+            fprintf(f, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": %d, "
+                       "\"args\": {\"name\": ", pid, e->tid);
+            json_string(f, e->detail);
+            fprintf(f, "}}");
+        }
+        fprintf(f, ",\n{\"name\": ");
+        json_string(f, e->ph == 'B' && e->detail[0] ? e->detail : e->name);
+        fprintf(f, ", \"ph\": \"%c\", \"pid\": %d, \"tid\": %d, \"ts\": %.3f",
+                e->ph, pid, e->tid, (double)(e->ts - base) / 1e3);
+        if (e->ph == 'X') fprintf(f, ", \"dur\": %.3f", (double)e->dur / 1e3);
+        if (e->ph == 'i') fprintf(f, ", \"s\": \"t\"");
+        if (e->detail[0] || e->status >= 0) {
+            fprintf(f, ", \"args\": {");
+            if (e->detail[0]) {
+                fprintf(f, "\"cmd\": ");
+                json_string(f, e->detail);
+            }
+            if (e->status >= 0) fprintf(f, "%s\"status\": %d", e->detail[0] ? ", " : "", e->status);
+            fprintf(f, "}");
+        }
+        fprintf(f, "}");
+        n++;
+    }
+    fprintf(f, "\n]}\n");
+    if (fclose(f) != 0) { perror(path); return 1; }
+    out_printf("trace: %zu events written to %s\n", n, path);
+    return 0;
+}
+
+// trace [status] | trace dump FILE | trace clear
+int builtin_trace(char **args)
+{
+    if (!args[1] || strcmp(args[1], "status") == 0) {
+        uint64_t head = ring ? ring->head : 0, cap = ring ? ring->cap : 0;
+        out_printf("xtrace %s, %llu events kept (ring of %llu)\n", opt_xtrace ? "on" : "off",
+                   (unsigned long long)(head < cap ? head : cap), (unsigned long long)cap);
+        return 0;
+    }
+    if (strcmp(args[1], "dump") == 0 && args[2])
+        return trace_dump(args[2]);
+    if (strcmp(args[1], "clear") == 0) {
+        if (ring) {
+            // unpublish every slot, or a stale one could pass the seq check again
+            memset(ring->ev, 0, ring->cap * sizeof(trace_ev_t));
+            __atomic_store_n(&ring->head, 0, __ATOMIC_RELEASE);
+        }
+        return 0;
+    }
+    fprintf(stderr, "myshell: trace: usage: trace [status] | trace dump FILE | trace clear\n");
+    return 2;
+}
@@ -0,0 +1,393 @@
+#include "shell.h"
+#include <sys/stat.h>
+
+/* ------------ echo, test/[, printf in the shell ------------ */
+// Scripts spend most of their commands on these; running them in-process
+// saves a fork+exec each. Output goes through the builtin output buffer.
+
+// Write the escape sequence after a backslash at p; returns the position
+// after it. *stop is set by '\c' (no further output). In a printf format
+// (fmt) an octal escape is \NNN; in echo -e and %b arguments it is \0NNN.
+static const char* put_escape(const char *p, int *stop, int fmt)
+{
+    char c;
+    if (fmt && *p >= '0' && *p <= '7') {
+        int v = 0, k = 0;
+        while (k < 3 && *p >= '0' && *p <= '7') { v = v * 8 + (*p++ - '0'); k++; }
+        c = (char)v;
+        out_write(&c, 1);
+        return p;
+    }
+    switch (*p) {
+    case 'n':  c = '\n'; break;
+    case 't':  c = '\t'; break;
+    case 'r':  c = '\r'; break;
+    case 'a':  c = '\a'; break;
+    case 'b':  c = '\b'; break;
+    case 'f':  c = '\f'; break;
+    case 'v':  c = '\v'; break;
+    case 'e':  c = 27;   break;
+    case '\\': c = '\\'; break;
+    case 'c':  *stop = 1; return p + 1;
+    case '0': {
+        // \0nnn: up to three octal digits
+        int v = 0, k = 0;
+        p++;
+        while (k < 3 && *p >= '0' && *p <= '7') { v = v * 8 + (*p++ - '0'); k++; }
+        c = (char)v;
+        out_write(&c, 1);
+        return p;
+    }
+    case '\0':
+        out_write("\\", 1);
+        return p;
+    default:
+        // unknown: keep the backslash
+        out_write("\\", 1);
+        out_write(p, 1);
+        return p + 1;
+    }
+    out_write(&c, 1);
+    return p + 1;
+}
+
+// Write s, interpreting backslash escapes; returns 1 if '\c' was seen
+static int put_escaped(const char *s)
+{
+    int stop = 0;
+    while (*s && !stop) {
+        const char *bs = strchr(s, '\\');
+        if (!bs) { out_write(s, strlen(s)); break; }
+        out_write(s, (size_t)(bs - s));
+        s = put_escape(bs + 1, &stop, 0);
+    }
+    return stop;
+}
+
+/* echo [-neE] [arg...] */
+int builtin_echo(char **args)
+{
+    int newline = 1, escapes = 0, i = 1;
+    // leading words made only of n/e/E after '-' are options
+    for (; args[i] && args[i][0] == '-' && args[i][1]; i++) {
+        const char *o = args[i] + 1;
+        if (strspn(o, "neE") != strlen(o)) break;
+        for (; *o; o++) {
+            if (*o == 'n') newline = 0;
+            else if (*o == 'e') escapes = 1;
+            else escapes = 0;
+        }
+    }
+    for (int first = i; args[i]; i++) {
+        if (i > first) out_write(" ", 1);
+        if (!escapes) out_write(args[i], strlen(args[i]));
+        else if (put_escaped(args[i])) return 0;
+    }
+    if (newline) out_write("\n", 1);
+    return 0;
+}
+
+/* ------------ test / [ ------------ */
+// Recursive descent over: expr = and ('-o' and)*, and = not ('-a' not)*,
+// not = '!' not | '(' expr ')' | primary. A primary is a binary test if
+// the word after it is a binary operator, else a unary test if it is a
+// unary operator with an operand, else a non-empty string test; this
+// covers the POSIX rules for up to four arguments.
+
+typedef struct {
+    char **av;
+    int    n, pos;
+    int    err;
+} tparse_t;
+
+static int t_expr(tparse_t *t);
+
+static void t_error(tparse_t *t, const char *msg, const char *arg)
+{
+    if (!t->err)
+        fprintf(stderr, "myshell: test: %s%s%s\n", arg ? arg : "", arg ? ": " : "", msg);
+    t->err = 1;
+}
+
+static int t_int(tparse_t *t, const char *s, long long *v)
+{
+    char *end;
+    errno = 0;
+    while (*s == ' ' || *s == '\t') s++;
+    *v = strtoll(s, &end, 10);
+    if (end == s || errno != 0) { t_error(t, "integer expression expected", s); return 0; }
+    while (*end == ' ' || *end == '\t') end++;
+    if (*end) { t_error(t, "integer expression expected", s); return 0; }
+    return 1;
+}
+
+static int is_binop(const char *s)
+{
+    static const char *ops[] = { "=", "==", "!=", "<", ">", "-eq", "-ne", "-lt", "-le",
+                                 "-gt", "-ge", "-nt", "-ot", "-ef", NULL };
+    for (int i = 0; ops[i]; i++)
+        if (strcmp(s, ops[i]) == 0) return 1;
+    return 0;
+}
+
+static int is_unop(const char *s)
+{
+    return s[0] == '-' && s[1] && !s[2] && strchr("bcdefghLnprsStuwxzOGk", s[1]);
+}
+
+static int t_binary(tparse_t *t, const char *a, const char *op, const char *b)
+{
+    if (strcmp(op, "=") == 0 || strcmp(op, "==") == 0) return strcmp(a, b) == 0;
+    if (strcmp(op, "!=") == 0) return strcmp(a, b) != 0;
+    if (strcmp(op, "<") == 0)  return strcmp(a, b) < 0;
+    if (strcmp(op, ">") == 0)  return strcmp(a, b) > 0;
+    if (strcmp(op, "-nt") == 0 || strcmp(op, "-ot") == 0 || strcmp(op, "-ef") == 0) {
+        struct stat sa, sb;
+        int ha = stat(a, &sa) == 0, hb = stat(b, &sb) == 0;
+        if (strcmp(op, "-ef") == 0)
+            return ha && hb && sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+        if (strcmp(op, "-nt") == 0)
+            return ha && (!hb || sa.st_mtim.tv_sec > sb.st_mtim.tv_sec ||
+                          (sa.st_mtim.tv_sec == sb.st_mtim.tv_sec && sa.st_mtim.tv_nsec > sb.st_mtim.tv_nsec));
+        return hb && (!ha || sa.st_mtim.tv_sec < sb.st_mtim.tv_sec ||
+                      (sa.st_mtim.tv_sec == sb.st_mtim.tv_sec && sa.st_mtim.tv_nsec < sb.st_mtim.tv_nsec));
+    }
+    long long x, y;
+    if (!t_int(t, a, &x) || !t_int(t, b, &y)) return 0;
+    if (strcmp(op, "-eq") == 0) return x == y;
+    if (strcmp(op, "-ne") == 0) return x != y;
+    if (strcmp(op, "-lt") == 0) return x < y;
+    if (strcmp(op, "-le") == 0) return x <= y;
+    if (strcmp(op, "-gt") == 0) return x > y;
+    return x >= y; // -ge
+}
+
+static int t_unary(tparse_t *t, char op, const char *a)
+{
+    struct stat sb;
+    switch (op) {
+    case 'n': return *a != '\0';
+    case 'z': return *a == '\0';
+    case 't': {
+        long long fd;
+        return t_int(t, a, &fd) && isatty((int)fd);
+    }
+    case 'h': case 'L': return lstat(a, &sb) == 0 && S_ISLNK(sb.st_mode);
+    case 'r': return access(a, R_OK) == 0;
+    case 'w': return access(a, W_OK) == 0;
+    case 'x': return access(a, X_OK) == 0;
+    }
+    if (stat(a, &sb) != 0) return 0;
+    switch (op) {
+    case 'e': return 1;
+    case 'f': return S_ISREG(sb.st_mode);
+    case 'd': return S_ISDIR(sb.st_mode);
+    case 'b': return S_ISBLK(sb.st_mode);
+    case 'c': return S_ISCHR(sb.st_mode);
+    case 'p': return S_ISFIFO(sb.st_mode);
+    case 'S': return S_ISSOCK(sb.st_mode);
+    case 's': return sb.st_size > 0;
+    case 'g': return (sb.st_mode & S_ISGID) != 0;
+    case 'u': return (sb.st_mode & S_ISUID) != 0;
+    case 'k': return (sb.st_mode & S_ISVTX) != 0;
+    case 'O': return sb.st_uid == geteuid();
+    case 'G': return sb.st_gid == getegid();
+    }
+    return 0;
+}
+
+static int t_not(tparse_t *t)
+{
+    if (t->pos >= t->n) { t_error(t, "argument expected", NULL); return 0; }
+    char **av = t->av;
+    int left = t->n - t->pos;
+    const char *w = av[t->pos];
+
+    // a binary operator in second position wins: [ "!" = "!" ], [ -f = x ]
+    if (left >= 3 && is_binop(av[t->pos + 1])) {
+        t->pos += 3;
+        return t_binary(t, w, av[t->pos - 2], av[t->pos - 1]);
+    }
+    if (strcmp(w, "!") == 0 && left >= 2) {
+        t->pos++;
+        return !t_not(t);
+    }
+    if (strcmp(w, "(") == 0 && left >= 2) {
+        t->pos++;
+        int r = t_expr(t);
+        if (t->pos >= t->n || strcmp(av[t->pos], ")") != 0) {
+            t_error(t, "')' expected", NULL);
+            return 0;
+        }
+        t->pos++;
+        return r;
+    }
+    if (is_unop(w) && left >= 2) {
+        t->pos += 2;
+        return t_unary(t, w[1], av[t->pos - 1]);
+    }
+    if (left == 2 && is_binop(av[t->pos + 1])) {
+        t_error(t, "missing argument", av[t->pos + 1]);
+        return 0;
+    }
+    t->pos++;
+    return *w != '\0';
+}
+
+static int t_and(tparse_t *t)
+{
+    int r = t_not(t);
+    while (!t->err && t->pos < t->n && strcmp(t->av[t->pos], "-a") == 0) {
+        t->pos++;
+        int rhs = t_not(t);
+        r = r && rhs;
+    }
+    return r;
+}
+
+static int t_expr(tparse_t *t)
+{
+    int r = t_and(t);
+    while (!t->err && t->pos < t->n && strcmp(t->av[t->pos], "-o") == 0) {
+        t->pos++;
+        int rhs = t_and(t);
+        r = r || rhs;
+    }
+    return r;
+}
+
+/* test expr / [ expr ] : 0 true, 1 false, 2 error */
+int builtin_test(char **args)
+{
+    int n = 0;
+    while (args[n + 1]) n++;
+    if (strcmp(args[0], "[") == 0) {
+        if (n == 0 || strcmp(args[n], "]") != 0) {
+            fprintf(stderr, "myshell: [: missing ']'\n");
+            return 2;
+        }
+        n--;
+    }
+    if (n == 0) return 1;
+    tparse_t t = { args + 1, n, 0, 0 };
+    int r = t_expr(&t);
+    if (!t.err && t.pos < t.n)
+        t_error(&t, "too many arguments", t.av[t.pos]);
+    if (t.err) return 2;
+    return r ? 0 : 1;
+}
+
+/* ------------ printf ------------ */
+// printf FORMAT [arg...]: %d %i %u %o %x %X %c %s %b %e %f %g (with flags,
+// width and precision, '*' included), %% and backslash escapes. The format
+// is reused while arguments remain, as in POSIX printf.
+
+static int pf_bad;
+
+static long long pf_int(const char *s)
+{
+    if (!s) return 0;
+    if (s[0] == '\'' || s[0] == '"') return (unsigned char)s[1]; // 'c = char code
+    char *end;
+    errno = 0;
+    long long v = strtoll(s, &end, 0);
+    if (end == s || *end || errno) {
+        fprintf(stderr, "myshell: printf: %s: invalid number\n", s);
+        pf_bad = 1;
+    }
+    return v;
+}
+
+static double pf_float(const char *s)
+{
+    if (!s) return 0;
+    char *end;
+    double v = strtod(s, &end);
+    if (end == s || *end) {
+        fprintf(stderr, "myshell: printf: %s: invalid number\n", s);
+        pf_bad = 1;
+    }
+    return v;
+}
+
+int builtin_printf(char **args)
+{
+    if (!args[1]) {
+        fprintf(stderr, "myshell: printf: usage: printf format [arguments]\n");
+        return 2;
+    }
+    const char *fmt = args[1];
+    char **av = args + 2;
+    pf_bad = 0;
+    int used;
+    do {
+        used = 0;
+        const char *p = fmt;
+        while (*p) {
+            if (*p == '\\') {
+                int stop = 0;
+                p = put_escape(p + 1, &stop, 1);
+                if (stop) return pf_bad;
+                continue;
+            }
+            if (*p != '%') {
+                size_t run = strcspn(p, "\\%");
+                out_write(p, run);
+                p += run;
+                continue;
+            }
+            if (p[1] == '%') { out_write("%", 1); p += 2; continue; }
+
+            // copy the conversion spec, resolving '*' from the arguments
+            char spec[64];
+            size_t k = 0;
+            spec[k++] = *p++;
+            while (*p && strchr("-+ #0", *p) && k < 20) spec[k++] = *p++;
+            for (int part = 0; part < 2; part++) {
+                if (part == 1) {
+                    if (*p != '.') break;
+                    spec[k++] = *p++;
+                }
+                if (*p == '*') {
+                    p++;
+                    k += (size_t)snprintf(spec + k, sizeof(spec) - k - 8, "%d", (int)pf_int(*av));
+                    if (*av) { av++; used = 1; }
+                } else {
+                    while (*p >= '0' && *p <= '9' && k < 40) spec[k++] = *p++;
+                }
+            }
+            char conv = *p ? *p++ : '\0';
+            const char *arg = *av;
+            if (arg) { av++; used = 1; }
+            switch (conv) {
+            case 'd': case 'i':
+                spec[k++] = 'l'; spec[k++] = 'l'; spec[k++] = conv; spec[k] = '\0';
+                out_printf(spec, pf_int(arg));
+                break;
+            case 'u': case 'o': case 'x': case 'X':
+                spec[k++] = 'l'; spec[k++] = 'l'; spec[k++] = conv; spec[k] = '\0';
+                out_printf(spec, (unsigned long long)pf_int(arg));
+                break;
+            case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+                spec[k++] = conv; spec[k] = '\0';
+                out_printf(spec, pf_float(arg));
+                break;
+            case 'c':
+                spec[k++] = 'c'; spec[k] = '\0';
+                out_printf(spec, arg ? arg[0] : '\0');
+                break;
+            case 's':
+                spec[k++] = 's'; spec[k] = '\0';
+                out_printf(spec, arg ? arg : "");
+                break;
+            case 'b':
+                if (arg && put_escaped(arg)) return pf_bad;
+                break;
+            default:
+                fprintf(stderr, "myshell: printf: %%%c: invalid format character\n", conv ? conv : ' ');
+                return 1;
+            }
+        }
+    } while (used && *av);
+    return pf_bad;
+}
@@ -0,0 +1,78 @@
+#!/bin/bash
+# Tests for builtins as pipeline stages: a builtin feeding a pipe runs in a
+# forked copy of the shell, one in last position runs in the shell itself
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+run_exact "builtin-first" "pwd | cat
+echo a b | tr a-z A-Z
+printf '%s-\n' x y | cat
+jobs | cat" \
+"$PWD
+A B
+x-
+y-
+(no background jobs)"
+
+run_exact "builtin-in-the-middle" "printf 'b\na\n' | sort | echo mid | cat" "mid"
+
+run_exact "builtin-last-takes-effect" "printf 'v w\n' | read A B; echo [\$A][\$B]
+echo /tmp | cd /; pwd" \
+"[v][w]
+/"
+
+run_exact "builtin-first-is-a-copy" "cd /tmp | cat
+pwd
+X=1
+export X=2 | cat
+echo \$X" \
+"$PWD
+1"
+
+run_exact "statuses" "false | true; echo \$?
+true | false; echo \$?
+echo x | test -n x; echo \$?" \
+"0
+1
+0"
+
+run_exact "redirections" "echo hi | cat > $tmp/o; cat $tmp/o
+pwd > $tmp/p | cat; cat $tmp/p" \
+"hi
+$PWD"
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
@@ -0,0 +1,87 @@
+#!/bin/bash
+# Tests for $(...) and `...` command substitution: splitting, quoting,
+# nesting, status, and output that stays plain words (a '>' or '|' it
+# prints is never syntax)
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+run_exact "split-and-quoted" 'echo [$(echo "a   b")]
+echo "[$(echo "a   b")]"
+for w in $(echo 1 2); do echo w$w; done' \
+"[a b]
+[a   b]
+w1
+w2"
+
+run_exact "trailing-newlines-trimmed" 'echo "$(printf "a\n\n\n")"x
+echo "$(printf "a\n\nb")"' \
+"ax
+a
+
+b"
+
+run_exact "nested-and-backquotes" 'echo $(echo $(echo in))
+echo `echo bq` "`echo q`"
+X=$(echo val); echo $X' \
+"in
+bq q
+val"
+
+run_exact "external-and-pipeline" 'echo $(printf "x\ny\n" | tr x z)
+echo $(/bin/echo ext)' \
+"z y
+ext"
+
+run_exact "status-of-assignment" 'X=$(false); echo $?
+X=$(true); echo $?' \
+"1
+0"
+run_exact "status-of-empty-command" '$(false)' "" 1
+
+run_exact "output-redirection-is-a-word" "cd $tmp
+echo \$(echo '>') zz
+echo \$(echo '|') b
+ls zz" \
+"> zz
+| b
+ls: cannot access 'zz': No such file or directory" 2
+run_exact "output-keyword-is-a-word" '$(echo time) true
+echo $(echo "<<<" "@0")' \
+"Command not found: time
+<<< @0"
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
@@ -0,0 +1,77 @@
+#!/bin/bash
+# Tests for first-word completion from the background PATH index: names
+# found by the first scan, names added or removed later (inotify), a PATH
+# assignment, and builtins. Tab is typed into 'myshell -i'; the pauses
+# give the indexer thread time to catch up.
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+mkdir "$tmp/a" "$tmp/b"
+mkcmd() {
+  printf '#!/bin/sh\necho ran %s\n' "${1##*/}" > "$1"
+  chmod +x "$1"
+}
+mkcmd "$tmp/a/zqalpha"
+mkcmd "$tmp/b/zqbeta"
+
+# the session minus prompts must be exactly expect: each line as readline
+# echoed it after completion ('^G' where Tab found nothing to complete),
+# then the command's output
+check() {
+  local name="$1" out="$2" expect="$3"
+  out=$(printf "%s\n" "$out" | tr -d '\r' | sed 's/\a/^G/g' | sed 's/^.*> //' | grep -v -e '^$' -e '^Shell exited')
+  if [ "$out" == "$expect" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected:"; printf "%s\n" "$expect"
+    echo "---- got:"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+shell() { PATH="$tmp/a:/bin" HISTFILE= timeout 10 "$MYSHELL" -i 2>&1; }
+
+# Tests
+out=$({ sleep 1; printf 'zqal\t\n'; } | shell)
+check "first-scan" "$out" "zqalpha 
+ran zqalpha"
+
+out=$({ sleep 1; mkcmd "$tmp/a/zqgamma"; sleep 0.5; printf 'zqg\t\n'
+        rm "$tmp/a/zqgamma"; sleep 0.5; printf 'zqg\t\n'; } | shell)
+check "added-and-removed" "$out" "zqgamma 
+ran zqgamma
+zqg^G
+Command not found: zqg"
+
+out=$({ sleep 1; printf 'PATH=%s\n' "$tmp/b:/bin"; sleep 1; printf 'zqb\t\n'; printf 'zqal\t\n'; } | shell)
+check "path-assignment" "$out" "PATH=$tmp/b:/bin
+zqbeta 
+ran zqbeta
+zqal^G
+Command not found: zqal"
+
+out=$({ sleep 1; printf 'expo\tZQ=1\n'; printf 'if zqal\t\nthen echo $ZQ; fi\n'; } | shell)
+check "builtin-and-keyword-position" "$out" "export ZQ=1
+if zqalpha 
+then echo \$ZQ; fi
+ran zqalpha
+1"
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
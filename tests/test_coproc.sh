@@ -0,0 +1,101 @@
+#!/bin/bash
+# Tests for coproc, the read builtin and <&N / >&N redirections
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+run_exact "coproc-round-trip" 'coproc S sed -u s/^/got:/
+echo hello >&$S_IN
+read R <&$S_OUT
+echo $R
+printf "two words here\n" >&$S_IN
+read A B <&$S_OUT
+echo "$A|$B"' \
+"got:hello
+got:two|words here"
+
+run_exact "coproc-close" 'coproc C cat
+echo "[$C_IN]" | grep -c "^\[[0-9]"
+coproc -c C
+wait
+echo "[$C_IN][$C_OUT][$C_PID]"
+coproc -c C
+echo $?' \
+"1
+[][][]
+myshell: coproc: C: no such coprocess
+1"
+
+run_exact "coproc-usage" 'coproc 1bad cat' \
+"myshell: coproc: usage: coproc NAME cmd [args...] | coproc -c NAME | coproc" 2
+
+run_exact "read-splitting" 'read <<< "  a  b  "
+echo "<$REPLY>"
+read X Y Z <<< "1 2 3 4"
+echo "$X|$Y|$Z"
+read X Y Z <<< "1 2"
+echo "$X|$Y|$Z"' \
+"<a  b>
+1|2|3 4
+1|2|"
+
+# from a script file, read takes the line after it and the shell goes on
+# with the next one
+printf 'read L\nthis line is data\necho "$L"\n' > "$tmp/script"
+out=$("$MYSHELL" < "$tmp/script" 2>&1)
+if [ "$out" == "this line is data" ]; then
+  echo "PASS: read-from-script"; pass=$((pass+1))
+else
+  echo "FAIL: read-from-script (got: $out)"; fail=$((fail+1))
+fi
+
+run_exact "read-status" 'read Q < /dev/null
+echo $?
+read 1x <<< a' \
+"1
+myshell: read: '1x': not a valid identifier" 2
+
+# stderr bypasses the pipe, so it is not upper-cased
+run_exact "dup-redirections" 'echo err >&2 | tr a-z A-Z
+echo abc >&99
+echo $?
+cat <&0 <<< in' \
+"err
+myshell: 99: bad file descriptor
+1
+in"
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
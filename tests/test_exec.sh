@@ -0,0 +1,84 @@
+#!/bin/bash
+# Tests for launching external commands: posix_spawn and 'set +o spawn'
+# (fork + exec) must behave alike, including scripts without a '#!' line
+# and the 126/127 statuses
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+printf 'echo "no shebang $1"\nexit 4\n' > "$tmp/nsb"
+printf 'echo unused\n' > "$tmp/noexec"
+chmod +x "$tmp/nsb"
+
+# Tests
+for mode in spawn "+o spawn"; do
+  set_mode="set -o spawn"
+  [ "$mode" == "spawn" ] || set_mode="set $mode"
+  run_exact "pipeline ($mode)" "$set_mode
+printf 'b\na\n' | sort | tr a-z A-Z
+sh -c 'exit 7'; echo \$?" \
+"A
+B
+7"
+  run_exact "no-shebang ($mode)" "$set_mode
+$tmp/nsb x | cat
+$tmp/nsb y; echo \$?" \
+"no shebang x
+no shebang y
+4"
+  run_exact "not-found ($mode)" "$set_mode
+$tmp/missing; echo \$?
+nosuchcommand_xyz; echo \$?" \
+"Command not found: No such file or directory
+127
+Command not found: nosuchcommand_xyz
+127"
+  run_exact "not-executable ($mode)" "$set_mode
+$tmp/noexec; echo \$?" \
+"Command not found: Permission denied
+126"
+done
+
+# the last command of a script is exec'd in place: same statuses
+run_exact "tail-no-shebang" "$tmp/nsb z" "no shebang z" 4
+run_exact "tail-not-executable" "$tmp/noexec" "Command not found: Permission denied" 126
+
+run_exact "environment" "X=1 env | grep -c '^X=1\$'
+set +o spawn
+X=2 env | grep -c '^X=2\$'" \
+"1
+1"
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
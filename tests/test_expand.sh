@@ -0,0 +1,59 @@
+#!/bin/bash
+# Tests for variable expansion inside words and double quotes
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+run_exact "double-quotes" 'X=val
+echo "[$X]" "[${X}]" "${X}suffix" "$Xsuffix" "pre${X}post"' \
+"[val] [val] valsuffix  prevalpost"
+
+run_exact "unquoted-words" 'X=val
+echo ${X}y $X.y pre$X ${X}${X}' \
+"valy val.y preval valval"
+
+run_exact "empty-and-unset" 'E=
+echo "[$E]" [$E] "[${NOPE}]" x${NOPE}y' \
+"[] [] [] xy"
+
+run_exact "status" 'false; echo "$?" ${?} x$?' "1 1 x1"
+
+run_exact "literal-dollar" 'echo "$" "a$" '"'"'$X'"'"' "$-"' '$ a$ $X $-'
+
+run_exact "value-with-dollar-not-rescanned" 'A='"'"'$B'"'"'
+B=no
+echo "$A" $A' \
+'$B $B'
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
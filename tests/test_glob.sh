@@ -0,0 +1,80 @@
+#!/bin/bash
+# Tests for filename expansion of *, ? and [...] (run in a scratch directory)
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+mkdir "$tmp/sub"
+touch "$tmp/a1" "$tmp/a2" "$tmp/b1" "$tmp/c.txt" "$tmp/d.txt" "$tmp/.hidden" \
+      "$tmp/sub/x.c" "$tmp/sub/y.c"
+
+# Tests
+run_exact "star" "cd $tmp
+echo *
+echo *.txt" \
+"a1 a2 b1 c.txt d.txt sub
+c.txt d.txt"
+
+run_exact "question-and-brackets" "cd $tmp
+echo a?
+echo [ab]1
+echo [!a]?" \
+"a1 a2
+a1 b1
+b1"
+
+run_exact "dotfiles-and-directories" "cd $tmp
+echo .h*
+echo sub/*.c" \
+".hidden
+sub/x.c sub/y.c"
+
+run_exact "quoted-and-unmatched-stay-literal" "cd $tmp
+echo '*' \"a*\" z*" \
+"* a* z*"
+
+run_exact "for-list" "cd $tmp
+for f in *.txt; do echo f=\$f; done" \
+"f=c.txt
+f=d.txt"
+
+# each command line sees the directory as it is when it runs
+run_exact "new-file-seen" "cd $tmp
+touch a3; echo a?
+rm a3; echo a?" \
+"a1 a2 a3
+a1 a2"
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
@@ -0,0 +1,84 @@
+#!/bin/bash
+# Tests for the PATH lookup cache and the hash builtin
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+mkdir "$tmp/bin" "$tmp/bin2"
+printf '#!/bin/sh\necho one\n' > "$tmp/bin/mycmd"
+printf '#!/bin/sh\necho two\n' > "$tmp/bin2/mycmd"
+chmod +x "$tmp/bin/mycmd" "$tmp/bin2/mycmd"
+
+# Tests
+run_exact "hits-and-misses" "PATH=$tmp/bin
+hash
+mycmd
+mycmd
+hash" \
+"hash: hash table empty
+hash: 0 hits, 0 misses
+one
+one
+hits	command
+   1	$tmp/bin/mycmd
+hash: 1 hits, 1 misses"
+
+run_exact "hash-r-forgets" "PATH=$tmp/bin
+mycmd
+hash -r
+hash" \
+"one
+hash: hash table empty
+hash: 0 hits, 1 misses"
+
+run_exact "hash-name" "PATH=$tmp/bin
+hash mycmd
+hash nosuch
+echo \$?" \
+"myshell: hash: nosuch: not found
+1"
+
+# assigning PATH drops the cached paths
+run_exact "path-change" "PATH=$tmp/bin
+mycmd
+PATH=$tmp/bin2
+mycmd
+PATH=/nonexistent
+mycmd" \
+"one
+two
+Command not found: mycmd" 127
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
@@ -0,0 +1,95 @@
+#!/bin/bash
+# Tests for here-documents (<<, <<-, quoted delimiters) and here-strings (<<<)
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+run_exact "expanded-body" 'X=val
+cat <<EOF
+x=$X
+  indented
+EOF' \
+"x=val
+  indented"
+
+run_exact "quoted-delimiter" "X=val
+cat <<'EOF'
+x=\$X
+EOF" \
+"x=\$X"
+
+run_exact "strip-tabs" "X=val
+cat <<-EOF
+		tabbed \$X
+	EOF" \
+"tabbed val"
+
+run_exact "here-string" 'X=val
+cat <<< "here $X"
+tr a-z A-Z <<< word' \
+"here val
+WORD"
+
+run_exact "in-pipeline" 'cat <<EOF | tr a-z A-Z
+piped
+EOF' \
+"PIPED"
+
+run_exact "two-on-one-line" 'cat <<A; cat <<B
+first
+A
+second
+B' \
+"first
+second"
+
+run_exact "in-compound-commands" 'if true; then cat <<EOF
+in if
+EOF
+fi
+for i in 1 2; do cat <<EOF
+l$i
+EOF
+done' \
+"in if
+l1
+l2"
+
+run_exact "missing-delimiter" 'cat <<EOF
+abc' \
+"myshell: warning: here-document delimited by end of file (wanted 'EOF')
+abc"
+run_exact "no-word" 'cat <<' "myshell: syntax error near unexpected newline" 2
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
@@ -0,0 +1,79 @@
+#!/bin/bash
+# Tests for the persistent history: $HISTFILE is appended one line per
+# command, and history / !n see the entries of earlier sessions
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# an interactive session (-i) on the given input; prompts and the exit
+# banner are dropped so only the commands' output is left
+session() {
+  printf "%s\n" "$1" | HISTFILE="$tmp/hist" "$MYSHELL" -i 2>&1 | tr -d '\r' |
+    sed -e 's/^[^ ]*> //' -e '/^$/d' -e '/^Shell exited\.$/d'
+}
+
+check() {
+  local name="$1" got="$2" expect="$3"
+  if [ "$got" == "$expect" ]; then
+    echo "PASS: $name"; pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected:"; printf "%s\n" "$expect"
+    echo "---- got:"; printf "%s\n" "$got"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+session "echo first
+echo second" > /dev/null
+check "file-appended" "$(cat "$tmp/hist")" "echo first
+echo second"
+
+check "next-session-sees-it" "$(session "history
+!2")" \
+"history
+1  echo first
+2  echo second
+3  history
+!2
+echo second
+second"
+
+check "expansion-recorded" "$(tail -n 1 "$tmp/hist")" "echo second"
+
+check "history-n" "$(session "history 2")" \
+"history 2
+4  echo second
+5  history 2"
+
+check "histsize" "$(session "set -o histsize 2
+history")" \
+"set -o histsize 2
+history
+6  set -o histsize 2
+7  history"
+
+check "unknown-event" "$(session "!99")" \
+"!99
+myshell: !99: event not found"
+
+rm -f "$tmp/hist"
+printf 'echo x\n' | HISTFILE= "$MYSHELL" -i > /dev/null 2>&1
+check "empty-histfile-disables" "$(ls "$tmp")" ""
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
@@ -0,0 +1,90 @@
+#!/bin/bash
+# Tests for the job table: fg, bg and wait, their exit statuses and errors
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+run_exact "wait-job" "sh -c 'sleep 0.1; exit 3' &
+sh -c 'exit 4' &
+wait %1
+echo w1=\$?
+wait %2
+echo w2=\$?" \
+"w1=3
+w2=4"
+
+run_exact "wait-all" "sh -c 'sleep 0.2; exit 2' &
+sh -c 'exit 0' &
+wait
+echo \$?
+wait
+echo none=\$?" \
+"0
+none=0"
+
+run_exact "wait-pipeline-status" "sh -c 'exit 2' | sh -c 'sleep 0.1; exit 7' &
+wait %1
+echo \$?" "7"
+
+run_exact "fg-status" "sh -c 'sleep 0.1; exit 6' &
+fg
+echo fg=\$?" \
+"sh -c 'sleep 0.1; exit 6'
+fg=6"
+
+run_exact "fg-picks-job" "sh -c 'sleep 0.1; exit 1' &
+sh -c 'sleep 0.1; exit 2' &
+fg %1
+echo \$?
+fg
+echo \$?" \
+"sh -c 'sleep 0.1; exit 1'
+1
+sh -c 'sleep 0.1; exit 2'
+2"
+
+run_exact "no-such-job" "wait %9
+echo \$?
+fg
+echo \$?
+bg %3
+echo \$?" \
+"myshell: wait: %9: no such job
+127
+myshell: fg: current: no such job
+1
+myshell: bg: %3: no such job
+1"
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
@@ -0,0 +1,63 @@
+#!/bin/bash
+# Tests for input with no fixed limits: very long words, argument
+# lists, lines and values
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+long=$(head -c 100000 /dev/zero | tr '\0' a)
+args=$(seq 1 20000 | tr '\n' ' ')
+
+# Tests
+run_exact "long-word" "echo $long | wc -c
+/bin/echo $long | wc -c" \
+"100001
+100001"
+
+run_exact "many-arguments" "echo $args | wc -w
+/bin/echo $args | tr ' ' '\n' | tail -n 1" \
+"20000
+20000"
+
+run_exact "long-value" "X=$long
+echo \"\$X\$X\" | wc -c
+echo \${X}b | wc -c" \
+"200001
+100002"
+
+run_exact "many-commands-on-a-line" "$(for i in $(seq 1 2000); do printf 'X=%s; ' $i; done) echo \$X" \
+"2000"
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
@@ -0,0 +1,89 @@
+#!/bin/bash
+# Tests for the parallel builtin: output in argument order, the -j
+# concurrency cap, statuses, and a worker that stops
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# feed the script into myshell; stdout must be exactly expect (stderr
+# carries parallel's timing summary) and the exit status must be status
+run_out() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>/dev/null)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+run_out "argument-order" "parallel -j 4 sh -c 'sleep 0.\$0; echo \$0' ::: 3 2 1" \
+"3
+2
+1"
+
+run_out "braces-and-appended-arg" "parallel -j 2 echo x{}y ::: a b
+parallel echo arg ::: c" \
+"xay
+xby
+arg c"
+
+run_out "args-from-stdin" "printf 'p\nq\n' | parallel echo" \
+"p
+q"
+
+run_out "pipe-in-template-is-an-argument" "parallel echo {} '|' tr a-z A-Z ::: a" \
+"a | tr a-z A-Z"
+
+run_out "failed-count-is-status" "parallel sh -c 'exit \$0' ::: 0 3 0 4
+echo \$?" "2"
+
+# four 0.3s jobs take two rounds with -j 2 and one with -j 4
+secs() { printf "%s\n" "$1" | sed -n 's/^parallel: 4 jobs in \([0-9.]*\)s.*/\1/p'; }
+out=$(printf "%s\n" "parallel -j 2 sh -c 'sleep 0.3' {} ::: 1 2 3 4" | "$MYSHELL" 2>&1)
+two=$(secs "$out")
+out=$(printf "%s\n" "parallel -j 4 sh -c 'sleep 0.3' {} ::: 1 2 3 4" | "$MYSHELL" 2>&1)
+four=$(secs "$out")
+if [ -n "$two" ] && [ -n "$four" ] &&
+   awk -v a="$two" -v b="$four" 'BEGIN { exit !(a >= 0.6 && a < 0.9 && b >= 0.3 && b < 0.55) }'; then
+  echo "PASS: concurrency-cap"; pass=$((pass+1))
+else
+  echo "FAIL: concurrency-cap (-j 2: ${two}s, -j 4: ${four}s)"; fail=$((fail+1))
+fi
+
+# with job control (a terminal from script(1)) a stopped worker is killed
+# and counted as failed instead of holding its slot forever
+if command -v script > /dev/null; then
+  printf "%s\n" "parallel -j 2 sh -c 'if [ \$0 = b ]; then kill -STOP \$\$; fi; echo \$0' ::: a b c" \
+                'echo rc=$?' exit > "$tmp/in"
+  out=$(HISTFILE= timeout 10 script -qec "$MYSHELL" /dev/null < "$tmp/in" | tr -d '\r')
+  if printf "%s\n" "$out" | grep -q "parallel: b: stopped, killed" &&
+     printf "%s\n" "$out" | grep -q "^c$" && printf "%s\n" "$out" | grep -q "rc=1$"; then
+    echo "PASS: stopped-worker"; pass=$((pass+1))
+  else
+    echo "FAIL: stopped-worker"; printf "%s\n" "$out"; fail=$((fail+1))
+  fi
+fi
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
@@ -0,0 +1,120 @@
+#!/bin/bash
+# Tests for the command parser: quoting, lists, control flow, and
+# operators that only count when the parser saw them (a quoted or
+# expanded '|', '>' ... is an ordinary argument)
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+run_exact "quotes" "X=val
+echo 'single \$X' \"double \$X\" un\$X \"a  b\"   c" \
+"single \$X double val unval a  b c"
+
+run_exact "lists" "echo a;echo b
+false; echo \$?
+true && echo and
+false && echo never
+false || echo or
+true && false || echo chain
+! false && echo not" \
+"a
+b
+1
+and
+or
+chain
+not"
+
+run_exact "if-elif-else" "if false; then echo a; elif true; then echo b; else echo c; fi" "b"
+
+run_exact "loops" "for i in 1 2 3; do echo i\$i; done
+x=0
+while [ \$x = 0 ]; do echo w; x=1; done
+until [ \$x = 2 ]; do echo u; x=2; done" \
+"i1
+i2
+i3
+w
+u"
+
+run_exact "multiline-if" "if true
+then
+  echo yes
+fi" "yes"
+
+run_exact "pipeline-and-redirections" "echo abc | tr a-c x-z
+echo hi > $tmp/out
+cat < $tmp/out" \
+"xyz
+hi"
+
+run_exact "quoted-pipe-is-a-word" "echo \"|\" a" "| a"
+run_exact "expanded-pipe-is-a-word" "X='|'; echo \$X b" "| b"
+run_exact "quoted-redirection-is-a-word" "cd $tmp
+echo '>' q1
+ls q1" \
+"> q1
+ls: cannot access 'q1': No such file or directory" 2
+run_exact "quoted-operators" "echo '<' '<<' '<<<' '<&' '>&' '@0' @x" "< << <<< <& >& @0 @x"
+run_exact "quoted-keyword-is-a-command" "\"time\" true
+\"pipesize\" 1 true" \
+"Command not found: time
+Command not found: pipesize" 127
+# 'time' is the prefix keyword only when unquoted: it prints the times line
+out=$(printf 'time true\n' | "$MYSHELL" 2>&1)
+if [ "${out%% *}" == "total" ]; then
+  echo "PASS: time-prefix"; pass=$((pass+1))
+else
+  echo "FAIL: time-prefix (got: $out)"; fail=$((fail+1))
+fi
+
+run_exact "history-expansion" "echo one
+! false && echo not
+!1
+!9" \
+"one
+not
+echo one
+one
+myshell: !9: event not found"
+
+run_exact "syntax-error" "echo ok
+fi" "ok
+myshell: syntax error near unexpected token 'fi'" 2
+run_exact "unterminated-if" "if true; then echo x" \
+"myshell: syntax error: unexpected end of file" 2
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
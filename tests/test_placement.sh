@@ -0,0 +1,78 @@
+#!/bin/bash
+# Tests for the placement prefixes: affinity CPUS / @CPUS, nice and
+# ulimit in front of a command, and their errors
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+run_exact "ulimit-prefix" "ulimit -n 64 sh -c 'ulimit -n'
+ulimit -S -n 32 -s 1024 sh -c 'ulimit -n; ulimit -s'" \
+"64
+32
+1024"
+
+# the prefix applies to the command only: the shell keeps its limit
+soft=$(ulimit -n)
+run_exact "ulimit-prefix-leaves-shell" "ulimit -n 64 true
+sh -c 'ulimit -n'" "$soft"
+
+base=$(nice)
+run_exact "nice-prefix" "nice sh -c nice
+nice -n 5 nice
+nice -3 sh -c nice
+nice -n 2 nice -n 3 nice" \
+"$((base + 10))
+$((base + 5))
+$((base + 3))
+$((base + 5))"
+
+run_exact "affinity-prefix" "affinity 0 grep Cpus_allowed_list /proc/self/status
+@0 grep Cpus_allowed_list /proc/self/status | cat" \
+"Cpus_allowed_list:	0
+Cpus_allowed_list:	0"
+
+run_exact "prefixes-shown-by-jobs" "affinity 0 nice -n 4 ulimit -n 64 sleep 0.3 &
+jobs | sed 's/] [0-9]*/] PID/'
+wait" \
+"[1] PID  Running    affinity 0 nice -n 4 ulimit -n 64 sleep 0.3  (cpus 0, nice 4, ulimit -n 64)"
+
+run_exact "nice-n-without-argument" "nice -n" \
+"myshell: nice: -n: option requires an argument" 2
+run_exact "prefix-errors" "nice -n q true
+affinity x true
+ulimit -n 64 -q true" \
+"myshell: nice: q: invalid adjustment
+myshell: affinity: x: invalid CPU list
+myshell: ulimit: -q: invalid option" 2
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
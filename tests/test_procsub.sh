@@ -0,0 +1,57 @@
+#!/bin/bash
+# Tests for <(list) and >(list) process substitution
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+run_exact "diff-equal" 'diff <(echo a) <(echo a) && echo same' "same"
+run_exact "diff-status" 'diff <(echo a) <(echo b) > /dev/null; echo $?' "1"
+run_exact "read-several" 'cat <(echo x) <(echo y)
+paste <(printf "1\n2\n") <(printf "a\nb\n")' \
+"x
+y
+1	a
+2	b"
+run_exact "expands-in-list" 'X=hi; cat <(echo $X)' "hi"
+run_exact "word-is-a-dev-fd-path" 'echo <(true) | grep -c "^/dev/fd/[0-9]"' "1"
+
+# the command waits for the writer, so the file is complete afterwards
+run_exact "output-substitution" "echo data | tee >(tr a-z A-Z > $tmp/up) > /dev/null
+cat $tmp/up" "DATA"
+run_exact "to-a-builtin" "echo <(true) >(true) > /dev/null
+echo \$?" "0"
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
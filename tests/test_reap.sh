@@ -0,0 +1,69 @@
+#!/bin/bash
+# Tests for reaping background jobs as they exit: the statuses 'jobs' and
+# 'wait' report, and the notices of an interactive shell (-i), printed
+# after a foreground command and while the prompt sits idle
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+run_exact "all-reaped" "for i in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20; do /bin/true & done
+sleep 0.3
+jobs | grep -c 'Done(0)'" "20"
+
+run_exact "exit-statuses" "sh -c 'exit 3' &
+sleep 0.2
+jobs | sed 's/ [0-9]* / PID /'
+sh -c 'sleep 0.1; exit 5' &
+wait
+echo \$?" \
+"[1] PID  Done(3)    sh -c 'exit 3'
+5"
+
+# interactive: the notice comes after the foreground command...
+out=$(printf 'sleep 0.1 &\nsleep 0.3\necho x\n' | HISTFILE= "$MYSHELL" -i 2>&1)
+if printf "%s\n" "$out" | grep -A1 -E '> sleep 0\.3$' | grep -q -E '^\[1\] [0-9]+  Done\(0\) +sleep 0\.1$'; then
+  echo "PASS: notice-after-command"; pass=$((pass+1))
+else
+  echo "FAIL: notice-after-command"; printf "%s\n" "$out"; fail=$((fail+1))
+fi
+
+# ...or at the idle prompt, before any more input arrives
+out=$( (printf 'sleep 0.1 &\n'; sleep 0.5; printf 'echo x\n') | HISTFILE= "$MYSHELL" -i 2>&1 | tr '\r' '\n')
+if printf "%s\n" "$out" | grep -B3 -E '> echo x$' | grep -q -E '^\[1\] [0-9]+  Done\(0\) +sleep 0\.1$'; then
+  echo "PASS: notice-at-idle-prompt"; pass=$((pass+1))
+else
+  echo "FAIL: notice-at-idle-prompt"; printf "%s\n" "$out"; fail=$((fail+1))
+fi
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
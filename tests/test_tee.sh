@@ -0,0 +1,100 @@
+#!/bin/bash
+# Tests for the tee builtin (byte-for-byte copies on its zero-copy and
+# read/write paths, options it hands to the tee in PATH) and pipe capacity
+# (set -o pipesize, the pipesize prefix)
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+head -c 3000000 /dev/urandom > "$tmp/data"
+sum=$(cksum < "$tmp/data")
+
+# Tests
+run_exact "pipe-to-files" "cat $tmp/data | tee $tmp/t1 $tmp/t2 | cksum
+cksum < $tmp/t1
+cksum < $tmp/t2" \
+"$sum
+$sum
+$sum"
+
+run_exact "file-stdin-and-append" "tee $tmp/t3 < $tmp/data | cksum
+tee -a $tmp/t3 < /dev/null > /dev/null
+echo more | tee --append $tmp/t3 > /dev/null
+tail -c 5 $tmp/t3
+head -c 3000000 $tmp/t3 | cksum" \
+"$sum
+more
+$sum"
+
+run_exact "to-a-pipe-with-small-capacity" "pipesize 4096 cat $tmp/data | tee $tmp/t4 | cksum
+cksum < $tmp/t4" \
+"$sum
+$sum"
+
+mkdir "$tmp/d"
+run_exact "other-options-use-path-tee" "cd $tmp/d
+echo x | tee -p f1
+echo \$?
+echo y | tee -i -a f1 > /dev/null
+cat f1
+ls" \
+"x
+0
+x
+y
+f1"
+
+run_exact "utils-off-uses-path-tee" "set +o utils
+echo z | tee $tmp/f2 > /dev/null
+cat $tmp/f2" "z"
+
+if command -v python3 > /dev/null; then
+  getsz="python3 -c 'import fcntl; print(fcntl.fcntl(1, 1032))'" # F_GETPIPE_SZ
+  run_exact "pipesize" "set -o pipesize 1M
+set -o | grep pipesize
+$getsz | cat
+pipesize 128K $getsz | cat
+set -o pipesize 0
+$getsz | cat" \
+"pipesize     1048576
+1048576
+131072
+65536"
+fi
+
+run_exact "pipesize-usage" "pipesize x true" \
+"myshell: pipesize: usage: pipesize N[K|M] cmd | cmd..." 2
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
@@ -0,0 +1,68 @@
+#!/bin/bash
+# Tests for the 'time' prefix and per-job resource accounting
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+
+# feed the script into myshell; every pattern (an extended regex) must
+# match a line of stdout+stderr, in order
+run_match() {
+  local name="$1" input="$2"
+  shift 2
+  local out
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  local rest="$out" p
+  for p in "$@"; do
+    local line
+    line=$(printf "%s\n" "$rest" | grep -n -E -m1 -- "$p" | cut -d: -f1)
+    if [ -z "$line" ]; then
+      echo "FAIL: $name"
+      echo "---- no line matching: $p"
+      echo "---- got:"; printf "%s\n" "$out"
+      fail=$((fail+1))
+      return
+    fi
+    rest=$(printf "%s\n" "$rest" | tail -n +$((line+1)))
+  done
+  echo "PASS: $name"
+  pass=$((pass+1))
+}
+
+# Tests
+num='[0-9]+\.[0-9]{3}s'
+run_match "simple-command" "time sleep 0.2" \
+  "^total +real +0\.[2-9][0-9]{2}s +user +$num +sys +$num +maxrss +[0-9]+ KB\$"
+
+run_match "pipeline-stages" "time true | cat" \
+  "^\[1\] [0-9]+ +real +$num +user +$num +sys +$num +maxrss +[0-9]+ KB\$" \
+  "^\[2\] [0-9]+ +real" \
+  "^total +real"
+
+run_match "builtin" "time echo hi" "^hi\$" "^total +real +$num"
+
+run_match "cpu-time-counted" "time sh -c 'i=0; while [ \$i -lt 300000 ]; do i=\$((i+1)); done'" \
+  "^total +real +$num +user +0\.(0[1-9]|[1-9][0-9])[0-9]s"
+
+run_match "status-kept" "time false
+echo status \$?" "^total" "^status 1\$"
+
+run_match "jobs-l" "sleep 0.3 &
+sleep 0.05
+jobs -l
+wait" \
+  "^\[1\] Running +sleep 0\.3\$" \
+  "^ +[0-9]+ +real +$num +\(running\)"
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
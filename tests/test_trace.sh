@@ -0,0 +1,94 @@
+#!/bin/bash
+# Tests for the trace recorder: 'trace dump' writes valid Chrome trace
+# JSON (commands with quotes, backslashes and tabs included), the ring
+# size, and trace status/clear
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+# a pipeline, a builtin and an external command, then the dump; the JSON
+# must load, keep the command text exactly, and every B event have its E
+printf "%s\n" "set -o xtrace" "echo hi | cat" "true" "sh -c 'exit 3'" \
+              "echo \"a\\\"b\" 'c\\d	e'" "trace dump $tmp/t.json" | "$MYSHELL" > /dev/null 2>&1
+if python3 - "$tmp/t.json" <<'PY'
+import json, sys
+d = json.load(open(sys.argv[1]))
+ev = d["traceEvents"]
+cmds = [e["args"].get("cmd") for e in ev if "cmd" in e.get("args", {})]
+assert "echo hi | cat" in cmds and "echo \"a\\\"b\" 'c\\d\te'" in cmds, cmds
+names = {e["name"] for e in ev}
+assert "parse" in names and ("fork" in names or "spawn" in names), names
+open_ = {}
+for e in ev:
+    assert e["ph"] in ("M", "X", "B", "E", "i"), e
+    if e["ph"] == "B": open_[e["tid"]] = open_.get(e["tid"], 0) + 1
+    if e["ph"] == "E": open_[e["tid"]] -= 1
+assert all(v == 0 for v in open_.values()), open_
+PY
+then
+  echo "PASS: dump-is-valid-json"; pass=$((pass+1))
+else
+  echo "FAIL: dump-is-valid-json"; fail=$((fail+1))
+fi
+
+run_exact "empty-dump" "trace status
+trace dump $tmp/e.json
+python3 -m json.tool $tmp/e.json > /dev/null
+echo \$?" \
+"xtrace off, 0 events kept (ring of 0)
+trace: 0 events written to $tmp/e.json
+0"
+
+run_exact "ring-size-status-clear" "set -o tracesize 4
+set -o xtrace
+true
+true
+true
+true
+trace status
+trace clear
+trace status
+set +o xtrace
+trace status" \
+"xtrace on, 4 events kept (ring of 4)
+xtrace on, 2 events kept (ring of 4)
+xtrace off, 4 events kept (ring of 4)"
+
+run_exact "errors" "trace dump /nonexistent/x.json
+trace bogus" \
+"/nonexistent/x.json: No such file or directory
+myshell: trace: usage: trace [status] | trace dump FILE | trace clear" 2
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
@@ -0,0 +1,123 @@
+#!/bin/bash
+# Tests for the in-shell echo, printf and test/[ (their output and status
+# must match the programs in PATH, reached with 'set +o utils') and for
+# the exit builtin's status
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# run the script with the builtins and again with 'set +o utils'; stdout
+# (byte for byte, via od) must be the same. Error messages differ in
+# their prefix, so stderr is not compared; 'echo $?' lines compare statuses.
+run_same() {
+  local name="$1" input="$2"
+  local mine theirs
+  mine=$(printf "%s\n" "$input" | "$MYSHELL" 2>/dev/null | od -An -c)
+  theirs=$(printf "%s\n" "set +o utils" "$input" | "$MYSHELL" 2>/dev/null | od -An -c)
+  if [ -n "$mine" ] && [ "$mine" == "$theirs" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- PATH utilities:"; printf "%s\n" "$theirs"
+    echo "---- builtins:"; printf "%s\n" "$mine"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+run_same "echo" "echo a   b 'c  d'
+echo -n no-newline
+echo
+echo -e 'tab\there\0101|\\\\|\\c not this'
+echo -E 'raw\tno'
+echo -neE -n x
+echo -x -- -n"
+
+run_same "printf-conversions" "printf '%s|%5s|%-5s|%.2s\n' abc de fg hijk
+printf '%d %i %5d %-4d| %+d %05d\n' 42 -7 3 4 5 6
+printf '%x %X %o %u %#x %#o\n' 255 255 8 17 255 8
+printf '%f %.2f %e %g %10.3f\n' 1.5 3.14159 12345 0.0001 2.5
+printf '%c%c|%b|%%\n' xyz q 'a\tb'
+printf '%*d|%-*s|%.*f\n' 5 1 4 ab 1 2.25
+printf \"%d\n\" \"'A\""
+
+run_same "printf-escapes-and-reuse" "printf '\101\0102|\7|\tx\\\\y\n'
+printf '%s-%s\n' a b c
+printf 'no args %s|\n'
+printf 'stop\c here\n'
+printf '%b\n' 'o\0101k\c' after"
+
+run_same "printf-bad-number" "printf '%d|\n' 12x
+echo \$?"
+
+run_same "test-status" "test -n x; echo \$?
+test -z x; echo \$?
+test ; echo \$?
+test a = a; echo \$?
+test a != a; echo \$?
+test 3 -lt 10; echo \$?
+test 10 -le 9; echo \$?
+test -5 -gt -6; echo \$?
+test 7 -ge 7; echo \$?
+test 7 -eq 07; echo \$?
+test 1 -ne 1; echo \$?
+test -d /; echo \$?
+test -f /; echo \$?
+test -e /nonexistent; echo \$?
+test ! -d /; echo \$?
+test -d / -a -f /; echo \$?
+test -d / -o -f /; echo \$?
+test '(' a = b ')' -o x; echo \$?
+test '!' = '!'; echo \$?
+test -n =; echo \$?
+test x -eq 1; echo \$?
+test 5 -gt; echo \$?
+test a b c; echo \$?"
+
+run_same "bracket" "[ a = a ]; echo \$?
+[ -z '' ]; echo \$?
+[ 1 -gt 2 ]; echo \$?
+[ a = a; echo \$?"
+
+run_exact "test-missing-operand" "test 5 -gt" "myshell: test: -gt: missing argument" 2
+
+run_exact "exit-status" "exit 3
+echo not reached" "" 3
+run_exact "exit-last-status" "false
+exit" "" 1
+run_exact "exit-modulo-256" "exit 256" "" 0
+run_exact "exit-bad-number" "exit x" "myshell: exit: usage: exit [N]" 2
+run_exact "exit-too-many" "exit 1 2" "myshell: exit: usage: exit [N]" 2
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi
@@ -0,0 +1,113 @@
+#!/bin/bash
+# Tests for shell variables and the environment: export/unset and
+# NAME=VALUE prefixes that only last for one command
+# Run from repo root (where ./bin/myshell exists)
+
+MYSHELL=./bin/myshell
+if [ ! -x "$MYSHELL" ]; then
+  echo "ERROR: $MYSHELL not found or not executable. Build first (make)."
+  exit 2
+fi
+
+fail=0
+pass=0
+
+# feed the script into myshell; stdout+stderr must be exactly expect and
+# the shell's exit status (that of the last command) must be status
+run_exact() {
+  local name="$1" input="$2" expect="$3" status="${4:-0}"
+  local out rc
+  out=$(printf "%s\n" "$input" | "$MYSHELL" 2>&1)
+  rc=$?
+  if [ "$out" == "$expect" ] && [ "$rc" -eq "$status" ]; then
+    echo "PASS: $name"
+    pass=$((pass+1))
+  else
+    echo "FAIL: $name"
+    echo "---- expected (status $status):"; printf "%s\n" "$expect"
+    echo "---- got (status $rc):"; printf "%s\n" "$out"
+    fail=$((fail+1))
+  fi
+}
+
+# Tests
+run_exact "prefix-assignment" "X=1 env | grep ^X=
+echo [\$X]
+A=1 B=2 sh -c 'echo \$A\$B'
+echo [\$A\$B]" \
+"X=1
+[]
+12
+[]"
+
+run_exact "prefix-restores-old-value" "Y=base
+Y=tmp sh -c 'echo \$Y'
+echo \$Y
+env | grep -c ^Y=" \
+"tmp
+base
+0" 1
+
+run_exact "prefix-path" 'PATH=/nonexistent ls /
+ls -d /' \
+"Command not found: ls
+/"
+
+run_exact "export" "Y=base
+export Y
+env | grep ^Y=
+export Z=zz
+sh -c 'echo \$Z'" \
+"Y=base
+zz"
+
+run_exact "export-n-and-unset" "export Z=zz
+export -n Z
+sh -c 'echo [\$Z]'
+echo \$Z
+unset Z
+echo [\$Z]" \
+"[]
+zz
+[]"
+
+run_exact "bad-identifier" 'export 1bad' \
+"myshell: export: '1bad': not a valid identifier" 1
+
+# enough variables to grow the table several times; every one survives
+many=$(for i in $(seq 1 300); do echo "V$i=val$i"; done)
+run_exact "many-variables" "$many
+echo \$V1 \$V150 \$V300
+unset V150
+echo [\$V150] \$V149 \$V151
+V150=again; echo \$V150" \
+"val1 val150 val300
+[] val149 val151
+again"
+
+run_exact "set-unset-export-round-trip" "X=1
+X=22
+echo \$X
+unset X
+echo [\$X]
+X=3
+export X
+sh -c 'echo [\$X]'
+unset X
+sh -c 'echo [\$X]'
+X=4
+sh -c 'echo [\$X]'
+echo \$X" \
+"22
+[]
+[3]
+[]
+[]
+4"
+
+# Summary
+echo
+echo "Passed: $pass  Failed: $fail"
+if [ $fail -gt 0 ]; then
+  exit 1
+fi